@@ -9,6 +9,7 @@
 
 #include "soundfont.h"
 #include "wave.h"
+#include "utils/frameprofiler.h"
 
 using namespace Dx8;
 using namespace Tempest;
@@ -249,6 +250,7 @@ std::shared_ptr<Mixer::PatternInternal> Mixer::checkPattern(std::shared_ptr<Patt
   }
 
 void Mixer::mix(int16_t *out, size_t samples) {
+  FrameProfiler::Scope scope("Mixer::mix");
   std::memset(out,0,2*samples*sizeof(int16_t));
 
   auto cur = current;
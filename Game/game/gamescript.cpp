@@ -7,6 +7,7 @@
 #include "world/npc.h"
 #include "world/item.h"
 #include "world/interactive.h"
+#include "utils/framearena.h"
 
 #include <fstream>
 #include <cctype>
@@ -64,9 +65,11 @@ bool GameScript::GlobalOutput::isFinished() {
   }
 
 GameScript::GameScript(GameSession &owner)
-  :vm(owner.loadScriptCode()),owner(owner) {
+  :vm(owner.loadScriptCode()),owner(owner),prof(vm) {
   Daedalus::registerGothicEngineClasses(vm);
   owner.setupVmCommonApi(vm);
+  prof.setEnabled(owner.isProfileMode());
+  randGen.seed(owner.randomSeed());
   aiDefaultPipe.reset(new GlobalOutput(*this));
   initCommon();
   }
@@ -90,215 +93,194 @@ GameScript::~GameScript() {
   }
 
 void GameScript::initCommon() {
-  vm.registerExternalFunction("hlp_random",          [this](Daedalus::DaedalusVM& vm){ hlp_random(vm);         });
-  vm.registerExternalFunction("hlp_isvalidnpc",      [this](Daedalus::DaedalusVM& vm){ hlp_isvalidnpc(vm);     });
-  vm.registerExternalFunction("hlp_isvaliditem",     [this](Daedalus::DaedalusVM& vm){ hlp_isvaliditem(vm);    });
-  vm.registerExternalFunction("hlp_isitem",          [this](Daedalus::DaedalusVM& vm){ hlp_isitem(vm);         });
-  vm.registerExternalFunction("hlp_getnpc",          [this](Daedalus::DaedalusVM& vm){ hlp_getnpc(vm);         });
-  vm.registerExternalFunction("hlp_getinstanceid",   [this](Daedalus::DaedalusVM& vm){ hlp_getinstanceid(vm);  });
-
-  vm.registerExternalFunction("wld_insertnpc",       [this](Daedalus::DaedalusVM& vm){ wld_insertnpc(vm);  });
-  vm.registerExternalFunction("wld_insertitem",      [this](Daedalus::DaedalusVM& vm){ wld_insertitem(vm); });
-  vm.registerExternalFunction("wld_settime",         [this](Daedalus::DaedalusVM& vm){ wld_settime(vm);    });
-  vm.registerExternalFunction("wld_getday",          [this](Daedalus::DaedalusVM& vm){ wld_getday(vm);     });
-  vm.registerExternalFunction("wld_playeffect",      [this](Daedalus::DaedalusVM& vm){ wld_playeffect(vm); });
-  vm.registerExternalFunction("wld_stopeffect",      [this](Daedalus::DaedalusVM& vm){ wld_stopeffect(vm); });
-  vm.registerExternalFunction("wld_getplayerportalguild",
-                                                     [this](Daedalus::DaedalusVM& vm){ wld_getplayerportalguild(vm); });
-  vm.registerExternalFunction("wld_setguildattitude",[this](Daedalus::DaedalusVM& vm){ wld_setguildattitude(vm);     });
-  vm.registerExternalFunction("wld_getguildattitude",[this](Daedalus::DaedalusVM& vm){ wld_getguildattitude(vm);     });
-  vm.registerExternalFunction("wld_istime",          [this](Daedalus::DaedalusVM& vm){ wld_istime(vm);               });
-  vm.registerExternalFunction("wld_isfpavailable",   [this](Daedalus::DaedalusVM& vm){ wld_isfpavailable(vm);        });
-  vm.registerExternalFunction("wld_isnextfpavailable",
-                                                     [this](Daedalus::DaedalusVM& vm){ wld_isnextfpavailable(vm);    });
-  vm.registerExternalFunction("wld_ismobavailable",  [this](Daedalus::DaedalusVM& vm){ wld_ismobavailable(vm);       });
-  vm.registerExternalFunction("wld_setmobroutine",   [this](Daedalus::DaedalusVM& vm){ wld_setmobroutine(vm);        });
-  vm.registerExternalFunction("wld_getmobstate",     [this](Daedalus::DaedalusVM& vm){ wld_getmobstate(vm);          });
-  vm.registerExternalFunction("wld_assignroomtoguild",
-                                                     [this](Daedalus::DaedalusVM& vm){ wld_assignroomtoguild(vm);    });
-  vm.registerExternalFunction("wld_detectnpc",       [this](Daedalus::DaedalusVM& vm){ wld_detectnpc(vm);            });
-  vm.registerExternalFunction("wld_detectnpcex",     [this](Daedalus::DaedalusVM& vm){ wld_detectnpcex(vm);          });
-  vm.registerExternalFunction("wld_detectitem",      [this](Daedalus::DaedalusVM& vm){ wld_detectitem(vm);           });
-  vm.registerExternalFunction("wld_spawnnpcrange",   [this](Daedalus::DaedalusVM& vm){ wld_spawnnpcrange(vm);        });
-
-  vm.registerExternalFunction("mdl_setvisual",       [this](Daedalus::DaedalusVM& vm){ mdl_setvisual(vm);        });
-  vm.registerExternalFunction("mdl_setvisualbody",   [this](Daedalus::DaedalusVM& vm){ mdl_setvisualbody(vm);    });
-  vm.registerExternalFunction("mdl_setmodelfatness", [this](Daedalus::DaedalusVM& vm){ mdl_setmodelfatness(vm);  });
-  vm.registerExternalFunction("mdl_applyoverlaymds", [this](Daedalus::DaedalusVM& vm){ mdl_applyoverlaymds(vm);  });
-  vm.registerExternalFunction("mdl_applyoverlaymdstimed",
-                                                     [this](Daedalus::DaedalusVM& vm){ mdl_applyoverlaymdstimed(vm); });
-  vm.registerExternalFunction("mdl_removeoverlaymds",[this](Daedalus::DaedalusVM& vm){ mdl_removeoverlaymds(vm); });
-  vm.registerExternalFunction("mdl_setmodelscale",   [this](Daedalus::DaedalusVM& vm){ mdl_setmodelscale(vm);    });
-  vm.registerExternalFunction("mdl_startfaceani",    [this](Daedalus::DaedalusVM& vm){ mdl_startfaceani(vm);     });
-  vm.registerExternalFunction("mdl_applyrandomani",  [this](Daedalus::DaedalusVM& vm){ mdl_applyrandomani(vm);   });
-  vm.registerExternalFunction("mdl_applyrandomanifreq",
-                                                     [this](Daedalus::DaedalusVM& vm){ mdl_applyrandomanifreq(vm);});
-
-  vm.registerExternalFunction("npc_settofightmode",  [this](Daedalus::DaedalusVM& vm){ npc_settofightmode(vm);   });
-  vm.registerExternalFunction("npc_settofistmode",   [this](Daedalus::DaedalusVM& vm){ npc_settofistmode(vm);    });
-  vm.registerExternalFunction("npc_isinstate",       [this](Daedalus::DaedalusVM& vm){ npc_isinstate(vm);        });
-  vm.registerExternalFunction("npc_wasinstate",      [this](Daedalus::DaedalusVM& vm){ npc_wasinstate(vm);       });
-  vm.registerExternalFunction("npc_getdisttowp",     [this](Daedalus::DaedalusVM& vm){ npc_getdisttowp(vm);      });
-  vm.registerExternalFunction("npc_exchangeroutine", [this](Daedalus::DaedalusVM& vm){ npc_exchangeroutine(vm);  });
-  vm.registerExternalFunction("npc_isdead",          [this](Daedalus::DaedalusVM& vm){ npc_isdead(vm);           });
-  vm.registerExternalFunction("npc_knowsinfo",       [this](Daedalus::DaedalusVM& vm){ npc_knowsinfo(vm);        });
-  vm.registerExternalFunction("npc_settalentskill",  [this](Daedalus::DaedalusVM& vm){ npc_settalentskill(vm);   });
-  vm.registerExternalFunction("npc_gettalentskill",  [this](Daedalus::DaedalusVM& vm){ npc_gettalentskill(vm);   });
-  vm.registerExternalFunction("npc_settalentvalue",  [this](Daedalus::DaedalusVM& vm){ npc_settalentvalue(vm);   });
-  vm.registerExternalFunction("npc_gettalentvalue",  [this](Daedalus::DaedalusVM& vm){ npc_gettalentvalue(vm);   });
-  vm.registerExternalFunction("npc_setrefusetalk",   [this](Daedalus::DaedalusVM& vm){ npc_setrefusetalk(vm);    });
-  vm.registerExternalFunction("npc_refusetalk",      [this](Daedalus::DaedalusVM& vm){ npc_refusetalk(vm);       });
-  vm.registerExternalFunction("npc_hasitems",        [this](Daedalus::DaedalusVM& vm){ npc_hasitems(vm);         });
-  vm.registerExternalFunction("npc_getinvitem",      [this](Daedalus::DaedalusVM& vm){ npc_getinvitem(vm);       });
-  vm.registerExternalFunction("npc_removeinvitem",   [this](Daedalus::DaedalusVM& vm){ npc_removeinvitem(vm);    });
-  vm.registerExternalFunction("npc_removeinvitems",  [this](Daedalus::DaedalusVM& vm){ npc_removeinvitems(vm);   });
-  vm.registerExternalFunction("npc_getbodystate",    [this](Daedalus::DaedalusVM& vm){ npc_getbodystate(vm);     });
-  vm.registerExternalFunction("npc_getlookattarget", [this](Daedalus::DaedalusVM& vm){ npc_getlookattarget(vm);  });
-  vm.registerExternalFunction("npc_getdisttonpc",    [this](Daedalus::DaedalusVM& vm){ npc_getdisttonpc(vm);     });
-  vm.registerExternalFunction("npc_hasequippedarmor",[this](Daedalus::DaedalusVM& vm){ npc_hasequippedarmor(vm); });
-  vm.registerExternalFunction("npc_setperctime",     [this](Daedalus::DaedalusVM& vm){ npc_setperctime(vm);      });
-  vm.registerExternalFunction("npc_percenable",      [this](Daedalus::DaedalusVM& vm){ npc_percenable(vm);       });
-  vm.registerExternalFunction("npc_percdisable",     [this](Daedalus::DaedalusVM& vm){ npc_percdisable(vm);      });
-  vm.registerExternalFunction("npc_getnearestwp",    [this](Daedalus::DaedalusVM& vm){ npc_getnearestwp(vm);     });
-  vm.registerExternalFunction("npc_clearaiqueue",    [this](Daedalus::DaedalusVM& vm){ npc_clearaiqueue(vm);     });
-  vm.registerExternalFunction("npc_isplayer",        [this](Daedalus::DaedalusVM& vm){ npc_isplayer(vm);         });
-  vm.registerExternalFunction("npc_getstatetime",    [this](Daedalus::DaedalusVM& vm){ npc_getstatetime(vm);     });
-  vm.registerExternalFunction("npc_setstatetime",    [this](Daedalus::DaedalusVM& vm){ npc_setstatetime(vm);     });
-  vm.registerExternalFunction("npc_changeattribute", [this](Daedalus::DaedalusVM& vm){ npc_changeattribute(vm);  });
-  vm.registerExternalFunction("npc_isonfp",          [this](Daedalus::DaedalusVM& vm){ npc_isonfp(vm);           });
-  vm.registerExternalFunction("npc_getheighttonpc",  [this](Daedalus::DaedalusVM& vm){ npc_getheighttonpc(vm);   });
-  vm.registerExternalFunction("npc_getequippedmeleeweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_getequippedmeleeweapon(vm); });
-  vm.registerExternalFunction("npc_getequippedrangedweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_getequippedrangedweapon(vm); });
-  vm.registerExternalFunction("npc_getequippedarmor",[this](Daedalus::DaedalusVM& vm){ npc_getequippedarmor(vm); });
-  vm.registerExternalFunction("npc_canseenpc",       [this](Daedalus::DaedalusVM& vm){ npc_canseenpc(vm);        });
-  vm.registerExternalFunction("npc_hasequippedweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_hasequippedweapon(vm); });
-  vm.registerExternalFunction("npc_hasequippedmeleeweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_hasequippedmeleeweapon(vm); });
-  vm.registerExternalFunction("npc_hasequippedrangedweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_hasequippedrangedweapon(vm); });
-  vm.registerExternalFunction("npc_getactivespell",  [this](Daedalus::DaedalusVM& vm){ npc_getactivespell(vm);   });
-  vm.registerExternalFunction("npc_getactivespellisscroll",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_getactivespellisscroll(vm); });
-  vm.registerExternalFunction("npc_getactivespellcat",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_getactivespellcat(vm); });
-  vm.registerExternalFunction("npc_setactivespellinfo",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_setactivespellinfo(vm); });
-  vm.registerExternalFunction("npc_getactivespelllevel",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_getactivespelllevel(vm); });
-
-  vm.registerExternalFunction("npc_canseenpcfreelos",[this](Daedalus::DaedalusVM& vm){ npc_canseenpcfreelos(vm); });
-  vm.registerExternalFunction("npc_isinfightmode",   [this](Daedalus::DaedalusVM& vm){ npc_isinfightmode(vm);    });
-  vm.registerExternalFunction("npc_settarget",       [this](Daedalus::DaedalusVM& vm){ npc_settarget(vm);        });
-  vm.registerExternalFunction("npc_gettarget",       [this](Daedalus::DaedalusVM& vm){ npc_gettarget(vm);        });
-  vm.registerExternalFunction("npc_getnexttarget",   [this](Daedalus::DaedalusVM& vm){ npc_getnexttarget(vm);    });
-  vm.registerExternalFunction("npc_sendpassiveperc", [this](Daedalus::DaedalusVM& vm){ npc_sendpassiveperc(vm);  });
-  vm.registerExternalFunction("npc_checkinfo",       [this](Daedalus::DaedalusVM& vm){ npc_checkinfo(vm);        });
-  vm.registerExternalFunction("npc_getportalguild",  [this](Daedalus::DaedalusVM& vm){ npc_getportalguild(vm);   });
-  vm.registerExternalFunction("npc_isinplayersroom", [this](Daedalus::DaedalusVM& vm){ npc_isinplayersroom(vm);  });
-  vm.registerExternalFunction("npc_getreadiedweapon",[this](Daedalus::DaedalusVM& vm){ npc_getreadiedweapon(vm); });
-  vm.registerExternalFunction("npc_hasreadiedmeleeweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_hasreadiedmeleeweapon(vm); });
-  vm.registerExternalFunction("npc_isdrawingspell",  [this](Daedalus::DaedalusVM& vm){ npc_isdrawingspell(vm);   });
-  vm.registerExternalFunction("npc_isdrawingweapon", [this](Daedalus::DaedalusVM& vm){ npc_isdrawingweapon(vm);  });
-  vm.registerExternalFunction("npc_perceiveall",     [this](Daedalus::DaedalusVM& vm){ npc_perceiveall(vm);      });
-  vm.registerExternalFunction("npc_stopani",         [this](Daedalus::DaedalusVM& vm){ npc_stopani(vm);          });
-  vm.registerExternalFunction("npc_settrueguild",    [this](Daedalus::DaedalusVM& vm){ npc_settrueguild(vm);     });
-  vm.registerExternalFunction("npc_gettrueguild",    [this](Daedalus::DaedalusVM& vm){ npc_gettrueguild(vm);     });
-  vm.registerExternalFunction("npc_clearinventory",  [this](Daedalus::DaedalusVM& vm){ npc_clearinventory(vm);   });
-  vm.registerExternalFunction("npc_getattitude",     [this](Daedalus::DaedalusVM& vm){ npc_getattitude(vm);      });
-  vm.registerExternalFunction("npc_getpermattitude", [this](Daedalus::DaedalusVM& vm){ npc_getpermattitude(vm);  });
-  vm.registerExternalFunction("npc_setattitude",     [this](Daedalus::DaedalusVM& vm){ npc_setattitude(vm);      });
-  vm.registerExternalFunction("npc_settempattitude", [this](Daedalus::DaedalusVM& vm){ npc_settempattitude(vm);  });
-  vm.registerExternalFunction("npc_hasbodyflag",     [this](Daedalus::DaedalusVM& vm){ npc_hasbodyflag(vm);      });
-  vm.registerExternalFunction("npc_getlasthitspellid",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_getlasthitspellid(vm);});
-  vm.registerExternalFunction("npc_getlasthitspellcat",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_getlasthitspellcat(vm);});
-  vm.registerExternalFunction("npc_playani",         [this](Daedalus::DaedalusVM& vm){ npc_playani(vm);          });
-
-  vm.registerExternalFunction("npc_isdetectedmobownedbynpc",
-                                                     [this](Daedalus::DaedalusVM& vm){ npc_isdetectedmobownedbynpc(vm);});
-  vm.registerExternalFunction("npc_getdetectedmob",  [this](Daedalus::DaedalusVM& vm){ npc_getdetectedmob(vm);   });
-  vm.registerExternalFunction("npc_ownedbynpc",      [this](Daedalus::DaedalusVM& vm){ npc_ownedbynpc(vm);       });
-  vm.registerExternalFunction("npc_canseesource",    [this](Daedalus::DaedalusVM& vm){ npc_canseesource(vm);     });
-  vm.registerExternalFunction("npc_getdisttoitem",   [this](Daedalus::DaedalusVM& vm){ npc_getdisttoitem(vm);    });
-  vm.registerExternalFunction("npc_getheighttoitem", [this](Daedalus::DaedalusVM& vm){ npc_getheighttoitem(vm);  });
-
-  vm.registerExternalFunction("ai_output",           [this](Daedalus::DaedalusVM& vm){ ai_output(vm);            });
-  vm.registerExternalFunction("ai_stopprocessinfos", [this](Daedalus::DaedalusVM& vm){ ai_stopprocessinfos(vm);  });
-  vm.registerExternalFunction("ai_processinfos",     [this](Daedalus::DaedalusVM& vm){ ai_processinfos(vm);      });
-  vm.registerExternalFunction("ai_standup",          [this](Daedalus::DaedalusVM& vm){ ai_standup(vm);           });
-  vm.registerExternalFunction("ai_standupquick",     [this](Daedalus::DaedalusVM& vm){ ai_standupquick(vm);      });
-  vm.registerExternalFunction("ai_continueroutine",  [this](Daedalus::DaedalusVM& vm){ ai_continueroutine(vm);   });
-  vm.registerExternalFunction("ai_stoplookat",       [this](Daedalus::DaedalusVM& vm){ ai_stoplookat(vm);        });
-  vm.registerExternalFunction("ai_lookatnpc",        [this](Daedalus::DaedalusVM& vm){ ai_lookatnpc(vm);         });
-  vm.registerExternalFunction("ai_removeweapon",     [this](Daedalus::DaedalusVM& vm){ ai_removeweapon(vm);      });
-  vm.registerExternalFunction("ai_turntonpc",        [this](Daedalus::DaedalusVM& vm){ ai_turntonpc(vm);         });
-  vm.registerExternalFunction("ai_outputsvm",        [this](Daedalus::DaedalusVM& vm){ ai_outputsvm(vm);         });
-  vm.registerExternalFunction("ai_outputsvm_overlay",[this](Daedalus::DaedalusVM& vm){ ai_outputsvm_overlay(vm); });
-  vm.registerExternalFunction("ai_startstate",       [this](Daedalus::DaedalusVM& vm){ ai_startstate(vm);        });
-  vm.registerExternalFunction("ai_playani",          [this](Daedalus::DaedalusVM& vm){ ai_playani(vm);           });
-  vm.registerExternalFunction("ai_setwalkmode",      [this](Daedalus::DaedalusVM& vm){ ai_setwalkmode(vm);       });
-  vm.registerExternalFunction("ai_wait",             [this](Daedalus::DaedalusVM& vm){ ai_wait(vm);              });
-  vm.registerExternalFunction("ai_waitms",           [this](Daedalus::DaedalusVM& vm){ ai_waitms(vm);            });
-  vm.registerExternalFunction("ai_aligntowp",        [this](Daedalus::DaedalusVM& vm){ ai_aligntowp(vm);         });
-  vm.registerExternalFunction("ai_gotowp",           [this](Daedalus::DaedalusVM& vm){ ai_gotowp(vm);            });
-  vm.registerExternalFunction("ai_gotofp",           [this](Daedalus::DaedalusVM& vm){ ai_gotofp(vm);            });
-  vm.registerExternalFunction("ai_playanibs",        [this](Daedalus::DaedalusVM& vm){ ai_playanibs(vm);         });
-  vm.registerExternalFunction("ai_equiparmor",       [this](Daedalus::DaedalusVM& vm){ ai_equiparmor(vm);        });
-  vm.registerExternalFunction("ai_equipbestarmor",   [this](Daedalus::DaedalusVM& vm){ ai_equipbestarmor(vm);    });
-  vm.registerExternalFunction("ai_equipbestmeleeweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ ai_equipbestmeleeweapon(vm);  });
-  vm.registerExternalFunction("ai_equipbestrangedweapon",
-                                                     [this](Daedalus::DaedalusVM& vm){ ai_equipbestrangedweapon(vm); });
-  vm.registerExternalFunction("ai_usemob",           [this](Daedalus::DaedalusVM& vm){ ai_usemob(vm);            });
-  vm.registerExternalFunction("ai_teleport",         [this](Daedalus::DaedalusVM& vm){ ai_teleport(vm);          });
-  vm.registerExternalFunction("ai_stoppointat",      [this](Daedalus::DaedalusVM& vm){ ai_stoppointat(vm);       });
-  vm.registerExternalFunction("ai_drawweapon",       [this](Daedalus::DaedalusVM& vm){ ai_drawweapon(vm);  });
-  vm.registerExternalFunction("ai_readymeleeweapon", [this](Daedalus::DaedalusVM& vm){ ai_readymeleeweapon(vm);  });
-  vm.registerExternalFunction("ai_readyrangedweapon",[this](Daedalus::DaedalusVM& vm){ ai_readyrangedweapon(vm); });
-  vm.registerExternalFunction("ai_readyspell",       [this](Daedalus::DaedalusVM& vm){ ai_readyspell(vm);        });
-  vm.registerExternalFunction("ai_attack",           [this](Daedalus::DaedalusVM& vm){ ai_atack(vm);             });
-  vm.registerExternalFunction("ai_flee",             [this](Daedalus::DaedalusVM& vm){ ai_flee(vm);              });
-  vm.registerExternalFunction("ai_dodge",            [this](Daedalus::DaedalusVM& vm){ ai_dodge(vm);             });
-  vm.registerExternalFunction("ai_unequipweapons",   [this](Daedalus::DaedalusVM& vm){ ai_unequipweapons(vm);    });
-  vm.registerExternalFunction("ai_unequiparmor",     [this](Daedalus::DaedalusVM& vm){ ai_unequiparmor(vm);      });
-  vm.registerExternalFunction("ai_gotonpc",          [this](Daedalus::DaedalusVM& vm){ ai_gotonpc(vm);           });
-  vm.registerExternalFunction("ai_gotonextfp",       [this](Daedalus::DaedalusVM& vm){ ai_gotonextfp(vm);        });
-  vm.registerExternalFunction("ai_aligntofp",        [this](Daedalus::DaedalusVM& vm){ ai_aligntofp(vm);         });
-  vm.registerExternalFunction("ai_useitem",          [this](Daedalus::DaedalusVM& vm){ ai_useitem(vm);           });
-  vm.registerExternalFunction("ai_useitemtostate",   [this](Daedalus::DaedalusVM& vm){ ai_useitemtostate(vm);    });
-  vm.registerExternalFunction("ai_setnpcstostate",   [this](Daedalus::DaedalusVM& vm){ ai_setnpcstostate(vm);    });
-  vm.registerExternalFunction("ai_finishingmove",    [this](Daedalus::DaedalusVM& vm){ ai_finishingmove(vm);     });
-  vm.registerExternalFunction("ai_takeitem",         [this](Daedalus::DaedalusVM& vm){ ai_takeitem(vm);          });
-
-  vm.registerExternalFunction("mob_hasitems",        [this](Daedalus::DaedalusVM& vm){ mob_hasitems(vm);         });
-
-  vm.registerExternalFunction("ta_min",              [this](Daedalus::DaedalusVM& vm){ ta_min(vm);               });
-
-  vm.registerExternalFunction("log_createtopic",     [this](Daedalus::DaedalusVM& vm){ log_createtopic(vm);      });
-  vm.registerExternalFunction("log_settopicstatus",  [this](Daedalus::DaedalusVM& vm){ log_settopicstatus(vm);   });
-  vm.registerExternalFunction("log_addentry",        [this](Daedalus::DaedalusVM& vm){ log_addentry(vm);         });
-
-  vm.registerExternalFunction("equipitem",           [this](Daedalus::DaedalusVM& vm){ equipitem(vm);            });
-  vm.registerExternalFunction("createinvitem",       [this](Daedalus::DaedalusVM& vm){ createinvitem(vm);        });
-  vm.registerExternalFunction("createinvitems",      [this](Daedalus::DaedalusVM& vm){ createinvitems(vm);       });
-
-  vm.registerExternalFunction("info_addchoice",      [this](Daedalus::DaedalusVM& vm){ info_addchoice(vm);       });
-  vm.registerExternalFunction("info_clearchoices",   [this](Daedalus::DaedalusVM& vm){ info_clearchoices(vm);    });
-  vm.registerExternalFunction("infomanager_hasfinished",
-                                                     [this](Daedalus::DaedalusVM& vm){ infomanager_hasfinished(vm); });
-
-  vm.registerExternalFunction("snd_play",            [this](Daedalus::DaedalusVM& vm){ snd_play(vm);             });
-  vm.registerExternalFunction("snd_play3d",          [this](Daedalus::DaedalusVM& vm){ snd_play3d(vm);           });
-
-  vm.registerExternalFunction("game_initgerman",     [this](Daedalus::DaedalusVM& vm){ game_initgerman(vm);      });
-  vm.registerExternalFunction("game_initenglish",    [this](Daedalus::DaedalusVM& vm){ game_initenglish(vm);     });
-
-  vm.registerExternalFunction("exitsession",         [this](Daedalus::DaedalusVM& vm){ exitsession(vm);          });
+  bindExternal("hlp_random",                  &GameScript::hlp_random);
+  bindExternal("hlp_isvalidnpc",              &GameScript::hlp_isvalidnpc);
+  bindExternal("hlp_isvaliditem",             &GameScript::hlp_isvaliditem);
+  bindExternal("hlp_isitem",                  &GameScript::hlp_isitem);
+  bindExternal("hlp_getnpc",                  &GameScript::hlp_getnpc);
+  bindExternal("hlp_getinstanceid",           &GameScript::hlp_getinstanceid);
+
+  bindExternal("wld_insertnpc",               &GameScript::wld_insertnpc);
+  bindExternal("wld_insertitem",              &GameScript::wld_insertitem);
+  bindExternal("wld_settime",                 &GameScript::wld_settime);
+  bindExternal("wld_getday",                  &GameScript::wld_getday);
+  bindExternal("wld_playeffect",              &GameScript::wld_playeffect);
+  bindExternal("wld_stopeffect",              &GameScript::wld_stopeffect);
+  bindExternal("wld_getplayerportalguild",    &GameScript::wld_getplayerportalguild);
+  bindExternal("wld_setguildattitude",        &GameScript::wld_setguildattitude);
+  bindExternal("wld_getguildattitude",        &GameScript::wld_getguildattitude);
+  bindExternal("wld_istime",                  &GameScript::wld_istime);
+  bindExternal("wld_isfpavailable",           &GameScript::wld_isfpavailable);
+  bindExternal("wld_isnextfpavailable",       &GameScript::wld_isnextfpavailable);
+  bindExternal("wld_ismobavailable",          &GameScript::wld_ismobavailable);
+  bindExternal("wld_setmobroutine",           &GameScript::wld_setmobroutine);
+  bindExternal("wld_getmobstate",             &GameScript::wld_getmobstate);
+  bindExternal("wld_assignroomtoguild",       &GameScript::wld_assignroomtoguild);
+  bindExternal("wld_detectnpc",               &GameScript::wld_detectnpc);
+  bindExternal("wld_detectnpcex",             &GameScript::wld_detectnpcex);
+  bindExternal("wld_detectitem",              &GameScript::wld_detectitem);
+  bindExternal("wld_spawnnpcrange",           &GameScript::wld_spawnnpcrange);
+
+  bindExternal("mdl_setvisual",               &GameScript::mdl_setvisual);
+  bindExternal("mdl_setvisualbody",           &GameScript::mdl_setvisualbody);
+  bindExternal("mdl_setmodelfatness",         &GameScript::mdl_setmodelfatness);
+  bindExternal("mdl_applyoverlaymds",         &GameScript::mdl_applyoverlaymds);
+  bindExternal("mdl_applyoverlaymdstimed",    &GameScript::mdl_applyoverlaymdstimed);
+  bindExternal("mdl_removeoverlaymds",        &GameScript::mdl_removeoverlaymds);
+  bindExternal("mdl_setmodelscale",           &GameScript::mdl_setmodelscale);
+  bindExternal("mdl_startfaceani",            &GameScript::mdl_startfaceani);
+  bindExternal("mdl_applyrandomani",          &GameScript::mdl_applyrandomani);
+  bindExternal("mdl_applyrandomanifreq",      &GameScript::mdl_applyrandomanifreq);
+
+  bindExternal("npc_settofightmode",          &GameScript::npc_settofightmode);
+  bindExternal("npc_settofistmode",           &GameScript::npc_settofistmode);
+  bindExternal("npc_isinstate",               &GameScript::npc_isinstate);
+  bindExternal("npc_wasinstate",              &GameScript::npc_wasinstate);
+  bindExternal("npc_getdisttowp",             &GameScript::npc_getdisttowp);
+  bindExternal("npc_exchangeroutine",         &GameScript::npc_exchangeroutine);
+  bindExternal("npc_isdead",                  &GameScript::npc_isdead);
+  bindExternal("npc_knowsinfo",               &GameScript::npc_knowsinfo);
+  bindExternal("npc_settalentskill",          &GameScript::npc_settalentskill);
+  bindExternal("npc_gettalentskill",          &GameScript::npc_gettalentskill);
+  bindExternal("npc_settalentvalue",          &GameScript::npc_settalentvalue);
+  bindExternal("npc_gettalentvalue",          &GameScript::npc_gettalentvalue);
+  bindExternal("npc_setrefusetalk",           &GameScript::npc_setrefusetalk);
+  bindExternal("npc_refusetalk",              &GameScript::npc_refusetalk);
+  bindExternal("npc_hasitems",                &GameScript::npc_hasitems);
+  bindExternal("npc_getinvitem",              &GameScript::npc_getinvitem);
+  bindExternal("npc_removeinvitem",           &GameScript::npc_removeinvitem);
+  bindExternal("npc_removeinvitems",          &GameScript::npc_removeinvitems);
+  bindExternal("npc_getbodystate",            &GameScript::npc_getbodystate);
+  bindExternal("npc_getlookattarget",         &GameScript::npc_getlookattarget);
+  bindExternal("npc_getdisttonpc",            &GameScript::npc_getdisttonpc);
+  bindExternal("npc_hasequippedarmor",        &GameScript::npc_hasequippedarmor);
+  bindExternal("npc_setperctime",             &GameScript::npc_setperctime);
+  bindExternal("npc_percenable",              &GameScript::npc_percenable);
+  bindExternal("npc_percdisable",             &GameScript::npc_percdisable);
+  bindExternal("npc_getnearestwp",            &GameScript::npc_getnearestwp);
+  bindExternal("npc_clearaiqueue",            &GameScript::npc_clearaiqueue);
+  bindExternal("npc_isplayer",                &GameScript::npc_isplayer);
+  bindExternal("npc_getstatetime",            &GameScript::npc_getstatetime);
+  bindExternal("npc_setstatetime",            &GameScript::npc_setstatetime);
+  bindExternal("npc_changeattribute",         &GameScript::npc_changeattribute);
+  bindExternal("npc_isonfp",                  &GameScript::npc_isonfp);
+  bindExternal("npc_getheighttonpc",          &GameScript::npc_getheighttonpc);
+  bindExternal("npc_getequippedmeleeweapon",  &GameScript::npc_getequippedmeleeweapon);
+  bindExternal("npc_getequippedrangedweapon", &GameScript::npc_getequippedrangedweapon);
+  bindExternal("npc_getequippedarmor",        &GameScript::npc_getequippedarmor);
+  bindExternal("npc_canseenpc",               &GameScript::npc_canseenpc);
+  bindExternal("npc_hasequippedweapon",       &GameScript::npc_hasequippedweapon);
+  bindExternal("npc_hasequippedmeleeweapon",  &GameScript::npc_hasequippedmeleeweapon);
+  bindExternal("npc_hasequippedrangedweapon", &GameScript::npc_hasequippedrangedweapon);
+  bindExternal("npc_getactivespell",          &GameScript::npc_getactivespell);
+  bindExternal("npc_getactivespellisscroll",  &GameScript::npc_getactivespellisscroll);
+  bindExternal("npc_getactivespellcat",       &GameScript::npc_getactivespellcat);
+  bindExternal("npc_setactivespellinfo",      &GameScript::npc_setactivespellinfo);
+  bindExternal("npc_getactivespelllevel",     &GameScript::npc_getactivespelllevel);
+
+  bindExternal("npc_canseenpcfreelos",        &GameScript::npc_canseenpcfreelos);
+  bindExternal("npc_isinfightmode",           &GameScript::npc_isinfightmode);
+  bindExternal("npc_settarget",               &GameScript::npc_settarget);
+  bindExternal("npc_gettarget",               &GameScript::npc_gettarget);
+  bindExternal("npc_getnexttarget",           &GameScript::npc_getnexttarget);
+  bindExternal("npc_sendpassiveperc",         &GameScript::npc_sendpassiveperc);
+  bindExternal("npc_checkinfo",               &GameScript::npc_checkinfo);
+  bindExternal("npc_getportalguild",          &GameScript::npc_getportalguild);
+  bindExternal("npc_isinplayersroom",         &GameScript::npc_isinplayersroom);
+  bindExternal("npc_getreadiedweapon",        &GameScript::npc_getreadiedweapon);
+  bindExternal("npc_hasreadiedmeleeweapon",   &GameScript::npc_hasreadiedmeleeweapon);
+  bindExternal("npc_isdrawingspell",          &GameScript::npc_isdrawingspell);
+  bindExternal("npc_isdrawingweapon",         &GameScript::npc_isdrawingweapon);
+  bindExternal("npc_perceiveall",             &GameScript::npc_perceiveall);
+  bindExternal("npc_stopani",                 &GameScript::npc_stopani);
+  bindExternal("npc_settrueguild",            &GameScript::npc_settrueguild);
+  bindExternal("npc_gettrueguild",            &GameScript::npc_gettrueguild);
+  bindExternal("npc_clearinventory",          &GameScript::npc_clearinventory);
+  bindExternal("npc_getattitude",             &GameScript::npc_getattitude);
+  bindExternal("npc_getpermattitude",         &GameScript::npc_getpermattitude);
+  bindExternal("npc_setattitude",             &GameScript::npc_setattitude);
+  bindExternal("npc_settempattitude",         &GameScript::npc_settempattitude);
+  bindExternal("npc_hasbodyflag",             &GameScript::npc_hasbodyflag);
+  bindExternal("npc_getlasthitspellid",       &GameScript::npc_getlasthitspellid);
+  bindExternal("npc_getlasthitspellcat",      &GameScript::npc_getlasthitspellcat);
+  bindExternal("npc_playani",                 &GameScript::npc_playani);
+
+  bindExternal("npc_isdetectedmobownedbynpc", &GameScript::npc_isdetectedmobownedbynpc);
+  bindExternal("npc_getdetectedmob",          &GameScript::npc_getdetectedmob);
+  bindExternal("npc_ownedbynpc",              &GameScript::npc_ownedbynpc);
+  bindExternal("npc_canseesource",            &GameScript::npc_canseesource);
+  bindExternal("npc_getdisttoitem",           &GameScript::npc_getdisttoitem);
+  bindExternal("npc_getheighttoitem",         &GameScript::npc_getheighttoitem);
+
+  bindExternal("ai_output",                   &GameScript::ai_output);
+  bindExternal("ai_stopprocessinfos",         &GameScript::ai_stopprocessinfos);
+  bindExternal("ai_processinfos",             &GameScript::ai_processinfos);
+  bindExternal("ai_standup",                  &GameScript::ai_standup);
+  bindExternal("ai_standupquick",             &GameScript::ai_standupquick);
+  bindExternal("ai_continueroutine",          &GameScript::ai_continueroutine);
+  bindExternal("ai_stoplookat",               &GameScript::ai_stoplookat);
+  bindExternal("ai_lookatnpc",                &GameScript::ai_lookatnpc);
+  bindExternal("ai_removeweapon",             &GameScript::ai_removeweapon);
+  bindExternal("ai_turntonpc",                &GameScript::ai_turntonpc);
+  bindExternal("ai_outputsvm",                &GameScript::ai_outputsvm);
+  bindExternal("ai_outputsvm_overlay",        &GameScript::ai_outputsvm_overlay);
+  bindExternal("ai_startstate",               &GameScript::ai_startstate);
+  bindExternal("ai_playani",                  &GameScript::ai_playani);
+  bindExternal("ai_setwalkmode",              &GameScript::ai_setwalkmode);
+  bindExternal("ai_wait",                     &GameScript::ai_wait);
+  bindExternal("ai_waitms",                   &GameScript::ai_waitms);
+  bindExternal("ai_aligntowp",                &GameScript::ai_aligntowp);
+  bindExternal("ai_gotowp",                   &GameScript::ai_gotowp);
+  bindExternal("ai_gotofp",                   &GameScript::ai_gotofp);
+  bindExternal("ai_playanibs",                &GameScript::ai_playanibs);
+  bindExternal("ai_equiparmor",               &GameScript::ai_equiparmor);
+  bindExternal("ai_equipbestarmor",           &GameScript::ai_equipbestarmor);
+  bindExternal("ai_equipbestmeleeweapon",     &GameScript::ai_equipbestmeleeweapon);
+  bindExternal("ai_equipbestrangedweapon",    &GameScript::ai_equipbestrangedweapon);
+  bindExternal("ai_usemob",                   &GameScript::ai_usemob);
+  bindExternal("ai_teleport",                 &GameScript::ai_teleport);
+  bindExternal("ai_stoppointat",              &GameScript::ai_stoppointat);
+  bindExternal("ai_drawweapon",               &GameScript::ai_drawweapon);
+  bindExternal("ai_readymeleeweapon",         &GameScript::ai_readymeleeweapon);
+  bindExternal("ai_readyrangedweapon",        &GameScript::ai_readyrangedweapon);
+  bindExternal("ai_readyspell",               &GameScript::ai_readyspell);
+  bindExternal("ai_attack",                   &GameScript::ai_atack);
+  bindExternal("ai_flee",                     &GameScript::ai_flee);
+  bindExternal("ai_dodge",                    &GameScript::ai_dodge);
+  bindExternal("ai_unequipweapons",           &GameScript::ai_unequipweapons);
+  bindExternal("ai_unequiparmor",             &GameScript::ai_unequiparmor);
+  bindExternal("ai_gotonpc",                  &GameScript::ai_gotonpc);
+  bindExternal("ai_gotonextfp",               &GameScript::ai_gotonextfp);
+  bindExternal("ai_aligntofp",                &GameScript::ai_aligntofp);
+  bindExternal("ai_useitem",                  &GameScript::ai_useitem);
+  bindExternal("ai_useitemtostate",           &GameScript::ai_useitemtostate);
+  bindExternal("ai_setnpcstostate",           &GameScript::ai_setnpcstostate);
+  bindExternal("ai_finishingmove",            &GameScript::ai_finishingmove);
+  bindExternal("ai_takeitem",                 &GameScript::ai_takeitem);
+
+  bindExternal("mob_hasitems",                &GameScript::mob_hasitems);
+
+  bindExternal("ta_min",                      &GameScript::ta_min);
+
+  bindExternal("log_createtopic",             &GameScript::log_createtopic);
+  bindExternal("log_settopicstatus",          &GameScript::log_settopicstatus);
+  bindExternal("log_addentry",                &GameScript::log_addentry);
+
+  bindExternal("equipitem",                   &GameScript::equipitem);
+  bindExternal("createinvitem",               &GameScript::createinvitem);
+  bindExternal("createinvitems",              &GameScript::createinvitems);
+
+  bindExternal("info_addchoice",              &GameScript::info_addchoice);
+  bindExternal("info_clearchoices",           &GameScript::info_clearchoices);
+  bindExternal("infomanager_hasfinished",     &GameScript::infomanager_hasfinished);
+
+  bindExternal("snd_play",                    &GameScript::snd_play);
+  bindExternal("snd_play3d",                  &GameScript::snd_play3d);
+
+  bindExternal("game_initgerman",             &GameScript::game_initgerman);
+  bindExternal("game_initenglish",            &GameScript::game_initenglish);
+
+  bindExternal("exitsession",                 &GameScript::exitsession);
 
   // vm.validateExternals();
 
@@ -702,25 +684,25 @@ const ParticleFx* GameScript::getParticleFx(const Daedalus::GEngineClasses::C_Pa
   return owner.loadParticleFx(k);
   }
 
-std::vector<GameScript::DlgChoise> GameScript::dialogChoises(Daedalus::GEngineClasses::C_Npc* player,
-                                                               Daedalus::GEngineClasses::C_Npc* hnpc,
-                                                               const std::vector<uint32_t>& except,
-                                                               bool includeImp) {
+void GameScript::dialogChoises(Daedalus::GEngineClasses::C_Npc* player,
+                               Daedalus::GEngineClasses::C_Npc* hnpc,
+                               const std::vector<uint32_t>& except,
+                               bool includeImp,
+                               std::vector<DlgChoise>& choise) {
   auto& npc = *hnpc;
   auto& pl  = *player;
 
   ScopeVar self (vm, vm.globalSelf(),  hnpc,   Daedalus::IC_Npc);
   ScopeVar other(vm, vm.globalOther(), player, Daedalus::IC_Npc);
 
-  std::vector<Daedalus::GEngineClasses::C_Info*> hDialog;
+  FrameVector<Daedalus::GEngineClasses::C_Info*> hDialog;
   for(auto& info : dialogsInfo) {
     if(info.npc==int32_t(npc.instanceSymbol)) {
       hDialog.push_back(&info);
       }
     }
 
-  std::vector<DlgChoise> choise;
-
+  size_t count = 0;
   for(int important=includeImp ? 1 : 0;important>=0;--important){
     for(auto& i:hDialog) {
       const Daedalus::GEngineClasses::C_Info& info = *i;
@@ -747,21 +729,22 @@ std::vector<GameScript::DlgChoise> GameScript::dialogChoises(Daedalus::GEngineCl
       if(!valid)
         continue;
 
-      DlgChoise ch;
-      ch.title    = info.description.c_str();
+      if(count==choise.size())
+        choise.emplace_back();
+      // assign into existing element, to reuse capacity of title
+      DlgChoise& ch = choise[count];
+      ch.title.assign(info.description.c_str());
       ch.scriptFn = info.information;
       ch.handle   = i;
       ch.isTrade  = info.trade!=0;
       ch.sort     = info.nr;
-      choise.emplace_back(std::move(ch));
-      }
-    if(!choise.empty()){
-      sort(choise);
-      return choise;
+      ++count;
       }
+    if(count>0)
+      break;
     }
+  choise.resize(count);
   sort(choise);
-  return choise;
   }
 
 std::vector<GameScript::DlgChoise> GameScript::updateDialog(const GameScript::DlgChoise &dlg, Npc& player,Npc& npc) {
@@ -1168,10 +1151,30 @@ int32_t GameScript::runFunction(const size_t fid) {
   auto&       sym  = dat.getSymbolByIndex(fid);
   const char* call = sym.name.c_str();(void)call; //for debuging
 
+  ScriptProfiler::Scope scope(prof,fid,ScriptProfiler::Function);
   int32_t ret = vm.runFunctionBySymIndex(fid);
   return ret;
   }
 
+void GameScript::bindExternal(const char* name, void (GameScript::*fn)(Daedalus::DaedalusVM&)) {
+  const size_t sym = vm.getDATFile().getSymbolIndexByName(name);
+  vm.registerExternalFunction(name,[this,fn,sym](Daedalus::DaedalusVM& vm){
+    ScriptProfiler::Scope scope(prof,sym,ScriptProfiler::External);
+    (this->*fn)(vm);
+    });
+  }
+
+void GameScript::saveProfile(const char* name) {
+  std::string folded = std::string(name)+".folded";
+  std::string trace  = std::string(name)+".json";
+
+  std::ofstream f0(folded);
+  prof.saveFolded(f0);
+  std::ofstream f1(trace);
+  prof.saveTrace(f1);
+  Log::i("script profile saved: \"",folded,"\", \"",trace,"\"");
+  }
+
 uint64_t GameScript::tickCount() const {
   return owner.tickCount();
   }
@@ -18,6 +18,7 @@
 #include "game/constants.h"
 #include "game/aistate.h"
 #include "game/questlog.h"
+#include "game/scriptprofiler.h"
 #include "graphics/pfxobjects.h"
 #include "ui/documentmenu.h"
 
@@ -115,7 +116,9 @@ class GameScript final {
     const ParticleFx*                                 getParticleFx(const char* symbol);
     const ParticleFx*                                 getParticleFx(const Daedalus::GEngineClasses::C_ParticleFXEmitKey& k);
 
-    auto dialogChoises(Daedalus::GEngineClasses::C_Npc *self, Daedalus::GEngineClasses::C_Npc *npc, const std::vector<uint32_t> &except, bool includeImp) -> std::vector<DlgChoise>;
+    // 'out' is reused: no heap allocations, once its capacity is big enough
+    void dialogChoises(Daedalus::GEngineClasses::C_Npc *self, Daedalus::GEngineClasses::C_Npc *npc, const std::vector<uint32_t> &except, bool includeImp,
+                       std::vector<DlgChoise>& out);
     auto updateDialog (const GameScript::DlgChoise &dlg, Npc &player, Npc &npc) -> std::vector<GameScript::DlgChoise>;
     void exec(const DlgChoise &dlg, Npc &player, Npc &npc);
 
@@ -158,6 +161,9 @@ class GameScript final {
 
     BodyState schemeToBodystate(const char* sc);
 
+    ScriptProfiler&          profiler() { return prof; }
+    void                     saveProfile(const char* name);
+
   private:
     void               initCommon();
 
@@ -188,6 +194,8 @@ class GameScript final {
     template<void(GameScript::*)(Daedalus::DaedalusVM &vm)>
     void  notImplementedFn(const char* name);
 
+    void  bindExternal(const char* name, void (GameScript::*fn)(Daedalus::DaedalusVM &vm));
+
     Item* getItem(Daedalus::GEngineClasses::C_Item* handle);
     Item* getItemById(size_t id);
     Npc*  getNpc(Daedalus::GEngineClasses::C_Npc*   handle);
@@ -399,6 +407,7 @@ class GameScript final {
 
     Daedalus::DaedalusVM                                        vm;
     GameSession&                                                owner;
+    ScriptProfiler                                              prof;
     std::mt19937                                                randGen;
 
     std::unique_ptr<SpellDefinitions>                           spells;
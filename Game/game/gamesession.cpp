@@ -177,6 +177,14 @@ bool GameSession::isRamboMode() const {
   return gothic.isRamboMode();
   }
 
+bool GameSession::isProfileMode() const {
+  return gothic.isProfileMode();
+  }
+
+uint32_t GameSession::randomSeed() const {
+  return gothic.randomSeed();
+  }
+
 const VersionInfo& GameSession::version() const {
   return gothic.version();
   }
@@ -367,9 +375,9 @@ const WorldStateStorage& GameSession::findStorage(const std::string &name) {
   return wss;
   }
 
-void GameSession::updateAnimation() {
+void GameSession::updateAnimation(float alpha) {
   if(wrld)
-    wrld->updateAnimation();
+    wrld->updateAnimation(alpha);
   }
 
 std::vector<GameScript::DlgChoise> GameSession::updateDialog(const GameScript::DlgChoise &dlg, Npc& player, Npc& npc) {
@@ -42,6 +42,8 @@ class GameSession final {
     void         exitSession();
 
     bool         isRamboMode() const;
+    bool         isProfileMode() const;
+    uint32_t     randomSeed() const;
     auto         version() const -> const VersionInfo&;
 
     const World* world() const { return wrld.get(); }
@@ -72,7 +74,7 @@ class GameSession final {
     void         tick(uint64_t dt);
     uint64_t     tickCount() const { return ticks; }
 
-    void         updateAnimation();
+    void         updateAnimation(float alpha);
 
     auto         updateDialog(const GameScript::DlgChoise &dlg, Npc &player, Npc &npc) -> std::vector<GameScript::DlgChoise>;
     void         dialogExec(const GameScript::DlgChoise &dlg, Npc &player, Npc &npc);
@@ -0,0 +1,144 @@
+#include "scriptprofiler.h"
+
+#include <chrono>
+#include <string>
+
+ScriptProfiler::ScriptProfiler(Daedalus::DaedalusVM& vm)
+  :vm(vm) {
+  reset();
+  }
+
+void ScriptProfiler::setEnabled(bool e) {
+  if(enabled==e)
+    return;
+  enabled = e;
+  reset();
+  }
+
+void ScriptProfiler::reset() {
+  nodes.clear();
+  edges.clear();
+  stack.clear();
+  events.clear();
+  eventsHead = 0;
+
+  nodes.emplace_back(); // root
+  epoch = timeNs();
+  }
+
+uint64_t ScriptProfiler::totalTime() const {
+  uint64_t ret = 0;
+  for(size_t i=1;i<nodes.size();++i)
+    if(nodes[i].parent==0)
+      ret += nodes[i].total;
+  return ret;
+  }
+
+uint64_t ScriptProfiler::timeNs() {
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+  }
+
+uint32_t ScriptProfiler::child(uint32_t parent, size_t sym, Kind k) {
+  const uint64_t key = (uint64_t(parent)<<32) | (uint64_t(sym & 0x7FFFFFFF)<<1) | uint64_t(k);
+  auto it = edges.find(key);
+  if(it!=edges.end())
+    return it->second;
+
+  Node n;
+  n.sym    = sym;
+  n.parent = parent;
+  n.kind   = k;
+  nodes.push_back(n);
+
+  const uint32_t id = uint32_t(nodes.size()-1);
+  edges.emplace(key,id);
+  return id;
+  }
+
+void ScriptProfiler::enter(size_t sym, Kind k) {
+  const uint32_t parent = stack.empty() ? 0 : stack.back().node;
+
+  Frame f;
+  f.node  = child(parent,sym,k);
+  f.begin = timeNs();
+  stack.push_back(f);
+  }
+
+void ScriptProfiler::leave() {
+  if(stack.empty())
+    return; // profiler was reset in between
+  const uint64_t end = timeNs();
+  const Frame    f   = stack.back();
+  stack.pop_back();
+
+  const uint64_t dt = end-f.begin;
+  auto& n = nodes[f.node];
+  n.count += 1;
+  n.total += dt;
+  n.self  += (dt>f.child ? dt-f.child : 0);
+  if(!stack.empty())
+    stack.back().child += dt;
+
+  Event ev;
+  ev.node  = f.node;
+  ev.depth = uint32_t(stack.size());
+  ev.begin = f.begin;
+  ev.dur   = dt;
+  if(events.size()<size_t(MaxEvents)) {
+    events.push_back(ev);
+    } else {
+    events[eventsHead] = ev;
+    eventsHead = (eventsHead+1)%MaxEvents;
+    }
+  }
+
+const char* ScriptProfiler::nameOf(const Node& n) const {
+  if(n.sym==size_t(-1))
+    return "<root>";
+  return vm.getDATFile().getSymbolByIndex(n.sym).name.c_str();
+  }
+
+void ScriptProfiler::pathOf(uint32_t node, std::string& out) const {
+  if(node==0)
+    return;
+  auto& n = nodes[node];
+  if(n.parent!=0) {
+    pathOf(n.parent,out);
+    out += ';';
+    }
+  out += nameOf(n);
+  }
+
+void ScriptProfiler::saveFolded(std::ostream& out) const {
+  std::string path;
+  for(size_t i=1;i<nodes.size();++i) {
+    auto& n = nodes[i];
+    if(n.count==0)
+      continue;
+    path.clear();
+    pathOf(uint32_t(i),path);
+    out << path << " " << (n.self/1000) << "\n";
+    }
+  }
+
+void ScriptProfiler::saveTrace(std::ostream& out) const {
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for(size_t i=0;i<events.size();++i) {
+    auto& ev = events[(eventsHead+i)%events.size()];
+    auto& n  = nodes[ev.node];
+    if(ev.begin<epoch)
+      continue;
+    if(!first)
+      out << ",";
+    first = false;
+    out << "\n{\"name\":\"" << nameOf(n) << "\","
+        << "\"cat\":\"" << (n.kind==External ? "external" : "script") << "\","
+        << "\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+        << "\"ts\":"  << double(ev.begin-epoch)/1000.0 << ","
+        << "\"dur\":" << double(ev.dur)/1000.0
+        << "}";
+    }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  }
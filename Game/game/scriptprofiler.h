@@ -0,0 +1,89 @@
+#pragma once
+
+#include <daedalus/DaedalusVM.h>
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+class ScriptProfiler final {
+  public:
+    explicit ScriptProfiler(Daedalus::DaedalusVM& vm);
+
+    enum Kind : uint8_t {
+      Function = 0,
+      External = 1,
+      };
+
+    struct Scope final {
+      Scope(ScriptProfiler& p, size_t sym, Kind k):owner(p.enabled ? &p : nullptr) {
+        if(owner!=nullptr)
+          owner->enter(sym,k);
+        }
+      Scope(const Scope&)=delete;
+      ~Scope() {
+        if(owner!=nullptr)
+          owner->leave();
+        }
+      ScriptProfiler* owner;
+      };
+
+    void     setEnabled(bool e);
+    bool     isEnabled() const { return enabled; }
+    void     reset();
+    // inclusive time of all top-level calls, in ns
+    uint64_t totalTime() const;
+
+    // folded-stack format, one line per call path: "fn0;fn1;ext <self-time in us>"
+    void     saveFolded(std::ostream& out) const;
+    // Chrome trace-event json, last 'MaxEvents' calls only
+    void     saveTrace (std::ostream& out) const;
+
+  private:
+    enum {
+      MaxEvents = 1<<16
+      };
+
+    struct Node final {
+      size_t   sym    = size_t(-1);
+      uint32_t parent = 0;
+      Kind     kind   = Function;
+      uint64_t count  = 0;
+      uint64_t total  = 0;
+      uint64_t self   = 0;
+      };
+
+    struct Frame final {
+      uint32_t node  = 0;
+      uint64_t begin = 0;
+      uint64_t child = 0;
+      };
+
+    struct Event final {
+      uint32_t node  = 0;
+      uint32_t depth = 0;
+      uint64_t begin = 0;
+      uint64_t dur   = 0;
+      };
+
+    void     enter(size_t sym, Kind k);
+    void     leave();
+    uint32_t child(uint32_t parent, size_t sym, Kind k);
+
+    static uint64_t timeNs();
+
+    void     pathOf(uint32_t node, std::string& out) const;
+    auto     nameOf(const Node& n) const -> const char*;
+
+    Daedalus::DaedalusVM&                  vm;
+    bool                                   enabled = false;
+    uint64_t                               epoch   = 0;
+
+    std::vector<Node>                      nodes;
+    std::unordered_map<uint64_t,uint32_t>  edges;
+    std::vector<Frame>                     stack;
+
+    std::vector<Event>                     events;
+    size_t                                 eventsHead = 0;
+  };
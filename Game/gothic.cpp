@@ -1,10 +1,14 @@
 #include "gothic.h"
 
+#include <Tempest/Application>
+#include <Tempest/File>
 #include <Tempest/Log>
 #include <Tempest/TextCodec>
 
 #include <zenload/zCMesh.h>
+#include <cstdio>
 #include <cstring>
+#include <cstdlib>
 #include <cctype>
 
 #include "game/definitions/visualfxdefinitions.h"
@@ -15,9 +19,11 @@
 #include "game/definitions/particlesdefinitions.h"
 
 #include "game/serialize.h"
+#include "graphics/pfxobjects.h"
 #include "utils/installdetect.h"
 #include "utils/fileutil.h"
 #include "utils/inifile.h"
+#include "utils/frameprofiler.h"
 
 using namespace Tempest;
 using namespace FileUtil;
@@ -59,6 +65,41 @@ Gothic::Gothic(const int argc, const char **argv) {
     else if(std::strcmp(argv[i],"-rambo")==0){
       isRambo=true;
       }
+    else if(std::strcmp(argv[i],"-profile")==0){
+      isProfile=true;
+      }
+    else if(std::strcmp(argv[i],"-headless")==0){
+      isHeadless=true;
+      if(i+1<argc && std::isdigit(argv[i+1][0])) {
+        ++i;
+        headlessTicks = uint32_t(std::strtoul(argv[i],nullptr,10));
+        }
+      }
+    else if(std::strcmp(argv[i],"-vtxcheck")==0){
+      isHeadless=true;
+      isVtxCheck=true;
+      }
+    else if(std::strcmp(argv[i],"-texcheck")==0){
+      isHeadless=true;
+      isTexCheck=true;
+      }
+    else if(std::strcmp(argv[i],"-packcheck")==0){
+      isHeadless=true;
+      isPackCheck=true;
+      }
+    else if(std::strcmp(argv[i],"-bindcheck")==0){
+      isHeadless=true;
+      isBindCheck=true;
+      }
+    else if(std::strcmp(argv[i],"-posecheck")==0){
+      isHeadless=true;
+      isPoseCheck=true;
+      }
+    else if(std::strcmp(argv[i],"-seed")==0){
+      ++i;
+      if(i<argc)
+        seed = uint32_t(std::strtoul(argv[i],nullptr,10));
+      }
     else if(std::strcmp(argv[i],"-dx12")==0){
       graphics = GraphicBackend::DirectX12;
       }
@@ -76,6 +117,11 @@ Gothic::Gothic(const int argc, const char **argv) {
     if(i=='\\')
       i='/';
 
+  randGen.seed(seed);
+  std::srand(seed);
+  PfxObjects::setSeed(seed);
+  FrameProfiler::setEnabled(isProfile);
+
   if(gpath.size()>0 && gpath.back()!='/')
     gpath.push_back('/');
 
@@ -107,6 +153,7 @@ Gothic::Gothic(const int argc, const char **argv) {
   }
 
 Gothic::~Gothic() {
+  waitSaveWrite();
   }
 
 Gothic::GraphicBackend Gothic::graphicsApi() const {
@@ -304,6 +351,14 @@ bool Gothic::isRamboMode() const {
   return isRambo;
   }
 
+bool Gothic::isProfileMode() const {
+  return isProfile;
+  }
+
+bool Gothic::isHeadlessMode() const {
+  return isHeadless;
+  }
+
 Gothic::LoadState Gothic::checkLoading() const {
   return loadingFlag.load();
   }
@@ -317,6 +372,7 @@ bool Gothic::finishLoading() {
     if(pendingGame!=nullptr)
       game = std::move(pendingGame);
     saveTex = Texture2d();
+    Resources::evictUnused();
     onWorldLoaded();
     return true;
     }
@@ -331,9 +387,46 @@ void Gothic::startSave(Tempest::Texture2d&& tex,
 
 void Gothic::startLoad(const char* banner,
                        const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f) {
+  // save-game, that is being loaded, can be still in flight
+  waitSaveWrite();
   implStartLoadSave(banner,true,f);
   }
 
+void Gothic::writeSave(const std::string& fname, std::vector<uint8_t>&& data) {
+  std::lock_guard<std::mutex> guard(syncSave);
+  if(saveTh.joinable())
+    saveTh.join();
+
+  auto d = std::make_shared<std::vector<uint8_t>>(std::move(data));
+  saveTh = std::thread([fname,d]() noexcept {
+    const uint64_t time = Application::tickCount();
+    // write into temporary file first: save-menu must not see incomplete header
+    const std::string tmp = fname+".tmp";
+    try {
+      {
+      Tempest::WFile f(tmp);
+      f.write(d->data(),d->size());
+      }
+      if(std::rename(tmp.c_str(),fname.c_str())!=0) {
+        // rename doesn't replace existing file on windows
+        std::remove(fname.c_str());
+        if(std::rename(tmp.c_str(),fname.c_str())!=0)
+          throw std::runtime_error("rename failed");
+        }
+      Tempest::Log::i("save \"",fname,"\": write ",Application::tickCount()-time,"ms, ",d->size()/1024,"Kb");
+      }
+    catch(...) {
+      Tempest::Log::e("unable to write save-game: \"",fname,"\"");
+      }
+    });
+  }
+
+void Gothic::waitSaveWrite() {
+  std::lock_guard<std::mutex> guard(syncSave);
+  if(saveTh.joinable())
+    saveTh.join();
+  }
+
 void Gothic::implStartLoadSave(const char* banner,
                                bool load,
                                const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f) {
@@ -348,6 +441,8 @@ void Gothic::implStartLoadSave(const char* banner,
 
   onStartLoading();
   auto g = clearGame().release();
+  if(load)
+    Resources::markUnused();
   try{
     auto l = std::thread([this,f,g,one]() noexcept {
       std::unique_ptr<GameSession> game(g);
@@ -412,9 +507,10 @@ void Gothic::tick(uint64_t dt) {
     game->tick(dt);
   }
 
-void Gothic::updateAnimation() {
+void Gothic::updateAnimation(float alpha) {
+  FrameProfiler::Scope scope("Gothic::updateAnimation");
   if(game)
-    game->updateAnimation();
+    game->updateAnimation(alpha);
   }
 
 void Gothic::quickSave() {
@@ -83,17 +83,29 @@ class Gothic final {
 
     bool      isDebugMode() const;
     bool      isRamboMode() const;
+    bool      isProfileMode() const;
+    bool      isHeadlessMode() const;
+    uint32_t  headlessTickCount() const { return headlessTicks; }
+    bool      isVertexCheckMode() const { return isVtxCheck; }
+    bool      isTextureCheckMode() const { return isTexCheck; }
+    bool      isPackCheckMode() const { return isPackCheck; }
+    bool      isBindCheckMode() const { return isBindCheck; }
+    bool      isPoseCheckMode() const { return isPoseCheck; }
+    uint32_t  randomSeed() const { return seed; }
     bool      isWindowMode() const { return isWindow; }
 
     LoadState checkLoading() const;
     bool      finishLoading();
     void      startLoad(const char *banner, const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f);
     void      startSave(Tempest::Texture2d&& tex, const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f);
+    // writes serialized save-game to disk on background thread, while game continues
+    void      writeSave(const std::string& fname, std::vector<uint8_t>&& data);
     void      cancelLoading();
 
     void      tick(uint64_t dt);
 
-    void      updateAnimation();
+    // alpha: position of render frame between previous and current simulation step
+    void      updateAnimation(float alpha);
     void      quickSave();
     void      quickLoad();
     void      save(const std::string& slot);
@@ -161,6 +173,15 @@ class Gothic final {
     uint16_t                                pauseSum=0;
     bool                                    isDebug=false;
     bool                                    isRambo=false;
+    bool                                    isProfile=false;
+    bool                                    isHeadless=false;
+    uint32_t                                headlessTicks=1000;
+    bool                                    isVtxCheck=false;
+    bool                                    isTexCheck=false;
+    bool                                    isPackCheck=false;
+    bool                                    isBindCheck=false;
+    bool                                    isPoseCheck=false;
+    uint32_t                                seed=std::mt19937::default_seed;
     VersionInfo                             vinfo;
     std::mt19937                            randGen;
 
@@ -172,6 +193,8 @@ class Gothic final {
     std::atomic_int                         loadProgress{0};
     std::thread                             loaderTh;
     std::atomic<LoadState>                  loadingFlag{LoadState::Idle};
+    std::mutex                              syncSave;
+    std::thread                             saveTh;
 
     std::unique_ptr<GameSession>            game, pendingGame;
     std::unique_ptr<FightAi>                fight;
@@ -196,6 +219,8 @@ class Gothic final {
                                                               bool load,
                                                               const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f);
 
+    void                                    waitSaveWrite();
+
     bool                                    validateGothicPath() const;
     void                                    detectGothicVersion();
     void                                    setupSettings();
@@ -1,5 +1,7 @@
 #include "painter3d.h"
 
+#include <cmath>
+
 #include "graphics/bounds.h"
 #include "graphics/lightsource.h"
 
@@ -14,12 +16,31 @@ Painter3d::~Painter3d() {
 
 void Painter3d::setFrustrum(const Matrix4x4& m) {
   frustrum.make(m);
+  hasViewPos = false;
+  }
+
+void Painter3d::setViewPosition(const Vec3& pos) {
+  viewPos    = pos;
+  hasViewPos = true;
   }
 
 bool Painter3d::isVisible(const Bounds& b) const {
   return frustrum.testPoint(b.midTr.x,b.midTr.y,b.midTr.z, b.r);
   }
 
+bool Painter3d::isVisible(const PackedMesh::Cluster& c, bool backfaceTest) const {
+  if(!frustrum.testPoint(c.pos.x,c.pos.y,c.pos.z, c.r))
+    return false;
+  if(!backfaceTest || !hasViewPos || c.coneCutoff>1.f)
+    return true;
+  // cluster is backfacing, if every view direction into its sphere lies within normal cone
+  const float dx = c.pos.x-viewPos.x;
+  const float dy = c.pos.y-viewPos.y;
+  const float dz = c.pos.z-viewPos.z;
+  const float d  = dx*c.coneAxis.x + dy*c.coneAxis.y + dz*c.coneAxis.z;
+  return d < c.coneCutoff*std::sqrt(dx*dx+dy*dy+dz*dz) + c.r;
+  }
+
 void Painter3d::setViewport(int x, int y, int w, int h) {
   enc.setViewport(x,y,w,h);
   }
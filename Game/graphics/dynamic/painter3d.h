@@ -8,6 +8,7 @@
 
 #include <vector>
 
+#include "graphics/mesh/submesh/packedmesh.h"
 #include "frustrum.h"
 #include "resources.h"
 
@@ -24,8 +25,10 @@ class Painter3d final {
     ~Painter3d();
 
     void setFrustrum(const Tempest::Matrix4x4& m);
+    void setViewPosition(const Tempest::Vec3& pos);
 
     bool isVisible(const Bounds& b) const;
+    bool isVisible(const PackedMesh::Cluster& c, bool backfaceTest) const;
 
     void setViewport(int x,int y,int w,int h);
 
@@ -50,6 +53,8 @@ class Painter3d final {
     Tempest::Encoder<Tempest::CommandBuffer>& enc;
 
     Frustrum                                  frustrum;
+    Tempest::Vec3                             viewPos;
+    bool                                      hasViewPos = false;
     std::vector<Resources::Vertex>            vboCpu;
     Tempest::VertexBuffer<Resources::Vertex>  vbo[Resources::MaxFramesInFlight];
   };
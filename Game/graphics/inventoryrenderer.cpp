@@ -37,6 +37,11 @@ void InventoryRenderer::reset() {
   items.clear();
   }
 
+void InventoryRenderer::resetBuckets() {
+  items.clear();
+  visual.dropEmptyBuckets();
+  }
+
 void InventoryRenderer::drawItem(int x, int y, int w, int h, const Item& item) {
   auto& itData = *item.handle();
   if(auto mesh=Resources::loadMesh(itData.visual.c_str())) {
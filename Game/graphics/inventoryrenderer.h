@@ -19,6 +19,8 @@ class InventoryRenderer {
     void draw(Tempest::Encoder<Tempest::CommandBuffer>& cmd, uint8_t fId);
 
     void reset();
+    // buckets are matched by Material(raw texture pointer): must be dropped, once textures are evicted
+    void resetBuckets();
     void drawItem(int x, int y, int w, int h, const Item &item);
 
   private:
@@ -12,6 +12,7 @@ using namespace Tempest;
 MdlVisual::MdlVisual()
   :skInst(std::make_unique<Pose>()) {
   pos.identity();
+  posRender = pos;
   }
 
 MdlVisual::~MdlVisual() {
@@ -355,11 +356,61 @@ void MdlVisual::setPos(float x, float y, float z) {
   }
 
 void MdlVisual::setPos(const Tempest::Matrix4x4 &m) {
-  pos = m;
+  pos       = m;
+  posRender = m;
+  lerped    = false;
   view.setObjMatrix(pos);
   syncAttaches();
   }
 
+void MdlVisual::commitPosition() {
+  prevPos    = pos;
+  hasPrevPos = true;
+  }
+
+static bool isLerpable(const Tempest::Matrix4x4& a, const Tempest::Matrix4x4& b) {
+  // teleports and sharp turns are not interpolated
+  const float maxDist = 200.f;
+  float dx = b.at(3,0)-a.at(3,0), dy = b.at(3,1)-a.at(3,1), dz = b.at(3,2)-a.at(3,2);
+  if(dx*dx+dy*dy+dz*dz>maxDist*maxDist)
+    return false;
+  float dot = 0, la = 0, lb = 0;
+  for(int i=0; i<3; ++i) {
+    dot += a.at(2,i)*b.at(2,i);
+    la  += a.at(2,i)*a.at(2,i);
+    lb  += b.at(2,i)*b.at(2,i);
+    }
+  return dot>0 && dot*dot>=0.81f*la*lb;
+  }
+
+void MdlVisual::interpolatePosition(float alpha) {
+  bool same = true;
+  for(int i=0; i<4 && same; ++i)
+    for(int r=0; r<4; ++r)
+      if(prevPos.at(i,r)!=pos.at(i,r)) {
+        same = false;
+        break;
+        }
+
+  if(!hasPrevPos || same || alpha>=1.f || !isLerpable(prevPos,pos)) {
+    if(lerped) {
+      lerped    = false;
+      posRender = pos;
+      view.setObjMatrix(pos);
+      syncAttaches(pos);
+      }
+    return;
+    }
+
+  // component-wise blend: fine for rotation deltas of a single simulation step
+  for(int i=0; i<4; ++i)
+    for(int r=0; r<4; ++r)
+      posRender.set(i,r,prevPos.at(i,r)+(pos.at(i,r)-prevPos.at(i,r))*alpha);
+  lerped = true;
+  view.setObjMatrix(posRender);
+  syncAttaches(posRender);
+  }
+
 void MdlVisual::setTarget(const Tempest::Vec3& p) {
   targetPos = p;
   }
@@ -386,13 +437,14 @@ void MdlVisual::updateWeaponSkeleton(const Item* weapon,const Item* range) {
   syncAttaches();
   }
 
-bool MdlVisual::updateAnimation(Npc* npc, World& world) {
+bool MdlVisual::updateAnimation(Npc* npc, World& world, bool evalPose) {
   Pose&    pose      = *skInst;
   uint64_t tickCount = world.tickCount();
 
   if(npc!=nullptr && npc->world().isInListenerRange(npc->position()))
     pose.processSfx(*npc,tickCount);
   pose.processPfx(*this,world,tickCount);
+  pose.commitEvents(tickCount);
 
   for(size_t i=0;i<effects.size();) {
     if(effects[i].timeUntil<tickCount) {
@@ -404,6 +456,9 @@ bool MdlVisual::updateAnimation(Npc* npc, World& world) {
     }
 
   solver.update(tickCount);
+  if(!evalPose)
+    return false;
+
   const bool changed = pose.update(tickCount);
 
   if(changed) {
@@ -722,19 +777,23 @@ void MdlVisual::rebindAttaches(Attach<View>& mesh, const Skeleton& from, const S
   }
 
 void MdlVisual::syncAttaches() {
+  syncAttaches(posRender);
+  }
+
+void MdlVisual::syncAttaches(const Tempest::Matrix4x4& at) {
   MdlVisual::MeshAttach* mesh[] = {&head,&sword,&bow,&ammunition,&stateItm};
   for(auto i:mesh)
-    syncAttaches(*i);
+    syncAttaches(*i,at);
   for(auto& i:item)
-    syncAttaches(i);
+    syncAttaches(i,at);
   for(auto& i:attach)
-    syncAttaches(i);
+    syncAttaches(i,at);
   for(auto& i:effects) {
-    i.view.setObjMatrix(pos);
+    i.view.setObjMatrix(at);
     i.view.setTarget(targetPos);
     }
-  pfx.view.setObjMatrix(pos);
-  hnpcVisual.view.setObjMatrix(pos);
+  pfx.view.setObjMatrix(at);
+  hnpcVisual.view.setObjMatrix(at);
   }
 
 const Skeleton* MdlVisual::visualSkeleton() const {
@@ -742,11 +801,11 @@ const Skeleton* MdlVisual::visualSkeleton() const {
   }
 
 template<class View>
-void MdlVisual::syncAttaches(Attach<View>& att) {
+void MdlVisual::syncAttaches(Attach<View>& att, const Tempest::Matrix4x4& at) {
   auto& pose = *skInst;
   if(att.view.isEmpty())
     return;
-  auto p = pos;
+  auto p = at;
   if(att.boneId<pose.transform().size())
     p.mul(pose.transform(att.boneId));
   att.view.setObjMatrix(p);
@@ -26,6 +26,9 @@ class MdlVisual final {
 
     void                           setPos(float x,float y,float z);
     void                           setPos(const Tempest::Matrix4x4 &m);
+    // render-side interpolation between two simulation steps
+    void                           commitPosition();
+    void                           interpolatePosition(float alpha);
     void                           setTarget(const Tempest::Vec3& p);
     void                           setVisual(const Skeleton *visual);
     void                           setYTranslationEnable(bool e);
@@ -61,7 +64,7 @@ class MdlVisual final {
     void                           updateWeaponSkeleton(const Item *sword, const Item *bow);
 
     const Pose&                    pose() const { return *skInst; }
-    bool                           updateAnimation(Npc* npc, World& world);
+    bool                           updateAnimation(Npc* npc, World& world, bool evalPose=true);
     void                           processLayers  (World& world);
     auto                           mapBone(const size_t boneId) const -> Tempest::Vec3;
     auto                           mapWeaponBone() const -> Tempest::Vec3;
@@ -86,6 +89,7 @@ class MdlVisual final {
     WeaponState                    fightMode() const { return fgtMode; }
     Tempest::Vec3                  displayPosition() const;
     const Tempest::Matrix4x4&      position() const { return pos; }
+    const Tempest::Matrix4x4&      renderPosition() const { return posRender; }
     float                          viewDirection() const;
 
     const Animation::Sequence*     continueCombo(Npc& npc, AnimationSolver::Anim a, WeaponState st, WalkBit wlk);
@@ -118,11 +122,15 @@ class MdlVisual final {
     template<class View>
     void rebindAttaches(Attach<View>& mesh,const Skeleton& from,const Skeleton& to);
     template<class View>
-    void syncAttaches(Attach<View>& mesh);
+    void syncAttaches(Attach<View>& mesh, const Tempest::Matrix4x4& at);
+    void syncAttaches(const Tempest::Matrix4x4& at);
 
     void rebindAttaches(const Skeleton& from,const Skeleton& to);
 
     Tempest::Matrix4x4             pos;
+    Tempest::Matrix4x4             prevPos, posRender;
+    bool                           hasPrevPos = false;
+    bool                           lerped     = false;
     Tempest::Vec3                  targetPos;
     MeshObjects::Mesh              view;
 
@@ -295,7 +295,7 @@ Animation::Sequence::Sequence(const std::string &fname) {
         }
       case ZenLoad::ModelAnimationParser::CHUNK_RAWDATA:
         data->nodeIndex = std::move(p.getNodeIndex());
-        data->samples   = p.getSamples();
+        data->samples.assign(p.getSamples());
         break;
       case ZenLoad::ModelAnimationParser::CHUNK_ERROR:
         throw std::runtime_error("animation load error");
@@ -607,19 +607,17 @@ void Animation::AnimData::setupMoveTr() {
   size_t sz = nodeIndex.size();
 
   if(samples.size()>0 && samples.size()>=sz) {
-    auto& a = samples[0].position;
-    auto& b = samples[samples.size()-sz].position;
-    moveTr.x = b.x-a.x;
-    moveTr.y = b.y-a.y;
-    moveTr.z = b.z-a.z;
+    const size_t b = samples.size()-sz;
+    moveTr.x = samples.px[b]-samples.px[0];
+    moveTr.y = samples.py[b]-samples.py[0];
+    moveTr.z = samples.pz[b]-samples.pz[0];
 
     tr.resize(samples.size()/sz);
     for(size_t i=0,r=0;i<samples.size();i+=sz,++r){
       auto& p  = tr[r];
-      auto& bi = samples[i].position;
-      p.x = bi.x-a.x;
-      p.y = bi.y-a.y;
-      p.z = bi.z-a.z;
+      p.x = samples.px[i]-samples.px[0];
+      p.y = samples.py[i]-samples.py[0];
+      p.z = samples.pz[i]-samples.pz[0];
       }
     static const float eps = 0.4f;
     for(auto& i:tr) {
@@ -631,9 +629,30 @@ void Animation::AnimData::setupMoveTr() {
     }
 
   if(samples.size()>0){
-    translate.x = samples[0].position.x;
-    translate.y = samples[0].position.y;
-    translate.z = samples[0].position.z;
+    translate.x = samples.px[0];
+    translate.y = samples.py[0];
+    translate.z = samples.pz[0];
+    }
+  }
+
+void Animation::Samples::assign(const std::vector<ZenLoad::zCModelAniSample>& smp) {
+  const size_t sz = smp.size();
+  qx.resize(sz);
+  qy.resize(sz);
+  qz.resize(sz);
+  qw.resize(sz);
+  px.resize(sz);
+  py.resize(sz);
+  pz.resize(sz);
+  for(size_t i=0;i<sz;++i) {
+    auto& s = smp[i];
+    qx[i] = s.rotation.x;
+    qy[i] = s.rotation.y;
+    qz[i] = s.rotation.z;
+    qw[i] = s.rotation.w;
+    px[i] = s.position.x;
+    py[i] = s.position.y;
+    pz[i] = s.position.z;
     }
   }
 
@@ -4,6 +4,8 @@
 #include <Tempest/Vec>
 #include <memory>
 
+#include "utils/framearena.h"
+
 class Npc;
 class MdlVisual;
 class World;
@@ -36,14 +38,23 @@ class Animation final {
       uint8_t              def_opt_frame=0;
       uint8_t              groundSounds=0;
       ZenLoad::EFightMode  weaponCh=ZenLoad::FM_LAST;
-      std::vector<EvTimed> timed;
+      FrameVector<EvTimed> timed;
+      };
+
+    // per-node samples, split by component to keep interpolation loops vectorizable
+    struct Samples final {
+      std::vector<float> qx, qy, qz, qw;
+      std::vector<float> px, py, pz;
+
+      size_t size() const { return qx.size(); }
+      void   assign(const std::vector<ZenLoad::zCModelAniSample>& smp);
       };
 
     struct AnimData final {
       Tempest::Vec3                               translate={};
       Tempest::Vec3                               moveTr={};
 
-      std::vector<ZenLoad::zCModelAniSample>      samples;
+      Samples                                     samples;
       std::vector<uint32_t>                       nodeIndex;
       std::vector<Tempest::Vec3>                  tr;
       bool                                        hasMoveTr=false;
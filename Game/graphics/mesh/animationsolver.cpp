@@ -38,10 +38,14 @@ void AnimationSolver::load(Serialize &fin) {
       ++sz;
     }
   overlay.resize(sz);
+  invalidateCache();
   }
 
 void AnimationSolver::setSkeleton(const Skeleton *sk) {
+  if(baseSk==sk)
+    return;
   baseSk = sk;
+  invalidateCache();
   }
 
 bool AnimationSolver::hasOverlay(const Skeleton* sk) const {
@@ -58,6 +62,7 @@ void AnimationSolver::addOverlay(const Skeleton* sk,uint64_t time) {
   ov.skeleton = sk;
   ov.time     = time;
   overlay.push_back(ov);
+  invalidateCache();
   }
 
 void AnimationSolver::delOverlay(const char *sk) {
@@ -71,21 +76,42 @@ void AnimationSolver::delOverlay(const Skeleton *sk) {
   for(size_t i=0;i<overlay.size();++i)
     if(overlay[i].skeleton==sk){
       overlay.erase(overlay.begin()+int(i));
+      invalidateCache();
       return;
       }
   }
 
 void AnimationSolver::clearOverlays() {
+  if(overlay.empty())
+    return;
   overlay.clear();
+  invalidateCache();
   }
 
 void AnimationSolver::update(uint64_t tickCount) {
+  bool changed = false;
   for(size_t i=0;i<overlay.size();){
     auto& ov = overlay[i];
-    if(ov.time!=0 && ov.time<tickCount)
-      overlay.erase(overlay.begin()+int(i)); else
+    if(ov.time!=0 && ov.time<tickCount) {
+      overlay.erase(overlay.begin()+int(i));
+      changed = true;
+      } else {
       ++i;
+      }
     }
+  if(changed)
+    invalidateCache();
+  }
+
+void AnimationSolver::invalidateCache() {
+  cache.clear();
+  }
+
+size_t AnimationSolver::CacheHash::operator()(const CacheKey& k) const {
+  uint64_t h = uint64_t(reinterpret_cast<uintptr_t>(k.a));
+  h ^= uint64_t(reinterpret_cast<uintptr_t>(k.b)) + 0x9e3779b97f4a7c15ull + (h<<6) + (h>>2);
+  h ^= uint64_t(k.c)                              + 0x9e3779b97f4a7c15ull + (h<<6) + (h>>2);
+  return size_t(h);
   }
 
 const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, WeaponState st, WalkBit wlkMode, const Pose& pose) const {
@@ -93,11 +119,11 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
   if(st==WeaponState::Fist) {
     if(a==Anim::Atack) {
       if(pose.isInAnim("S_FISTRUNL"))
-        return solveFrm("T_FISTATTACKMOVE");
-      return solveFrm("S_FISTATTACK");
+        return solveFrm("T_FISTATTACKMOVE",st);
+      return solveFrm("S_FISTATTACK",st);
       }
     if(a==Anim::AtackBlock)
-      return solveFrm("T_FISTPARADE_0");
+      return solveFrm("T_FISTPARADE_0",st);
     }
   else if(st==WeaponState::W1H || st==WeaponState::W2H) {
     if(a==Anim::Atack && (pose.isInAnim("S_1HRUNL") || pose.isInAnim("S_2HRUNL")))
@@ -141,13 +167,13 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
       return solveFrm("S_%sRUN",st);
     }
   if(a==Anim::MagNoMana)
-    return solveFrm("T_CASTFAIL");
+    return solveFrm("T_CASTFAIL",st);
   // Move
   if(a==Idle) {
     if(bool(wlkMode & WalkBit::WM_Dive))
-      return solveFrm("S_DIVE");
+      return solveFrm("S_DIVE",st);
     if(bool(wlkMode & WalkBit::WM_Swim))
-      return solveFrm("S_SWIM");
+      return solveFrm("S_SWIM",st);
     if(bool(wlkMode&WalkBit::WM_Sneak))
       return solveFrm("S_%sSNEAK",st);
     if(bool(wlkMode&WalkBit::WM_Walk))
@@ -158,7 +184,7 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
     if(bool(wlkMode & WalkBit::WM_Dive)) {
       if(pose.bodyState()==BS_DIVE)
         return solveFrm("S_DIVEF",st); else
-        return solveFrm("S_DIVE");
+        return solveFrm("S_DIVE",st);
       }
     if(bool(wlkMode & WalkBit::WM_Swim))
       return solveFrm("S_SWIMF",st);
@@ -172,9 +198,9 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
     }
   if(a==MoveL) {
     if(bool(wlkMode & WalkBit::WM_Dive))
-      return solveFrm("S_DIVE"); // ???
+      return solveFrm("S_DIVE",st); // ???
     if(bool(wlkMode & WalkBit::WM_Swim))
-      return solveFrm("S_SWIM"); // ???
+      return solveFrm("S_SWIM",st); // ???
     if(bool(wlkMode & WalkBit::WM_Sneak))
       return solveFrm("T_%sSNEAKSTRAFEL",st);
     if(bool(wlkMode & WalkBit::WM_Walk))
@@ -185,9 +211,9 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
     }
   if(a==MoveR) {
     if(bool(wlkMode & WalkBit::WM_Dive))
-      return solveFrm("S_DIVE"); // ???
+      return solveFrm("S_DIVE",st); // ???
     if(bool(wlkMode & WalkBit::WM_Swim))
-      return solveFrm("S_SWIM"); // ???
+      return solveFrm("S_SWIM",st); // ???
     if(bool(wlkMode & WalkBit::WM_Sneak))
       return solveFrm("T_%sSNEAKSTRAFER",st);
     if(bool(wlkMode & WalkBit::WM_Walk))
@@ -198,9 +224,9 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
     }
   if(a==Anim::MoveBack) {
     if(bool(wlkMode & WalkBit::WM_Dive))
-      return solveFrm("S_DIVE");
+      return solveFrm("S_DIVE",st);
     if(bool(wlkMode & WalkBit::WM_Swim))
-      return solveFrm("S_SWIMB");
+      return solveFrm("S_SWIMB",st);
     if(bool(wlkMode & WalkBit::WM_Sneak))
       return solveFrm("S_%sSNEAKBL",st);
     if(st==WeaponState::Fist)
@@ -210,11 +236,11 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
   // Rotation
   if(a==RotL) {
     if(bool(wlkMode & WalkBit::WM_Dive))
-      return solveFrm("T_DIVETURNL");
+      return solveFrm("T_DIVETURNL",st);
     if(bool(wlkMode & WalkBit::WM_Swim))
-      return solveFrm("T_SWIMTURNL");
+      return solveFrm("T_SWIMTURNL",st);
     if(bool(wlkMode & WalkBit::WM_Sneak))
-      return solveFrm("T_SNEAKTURNL");
+      return solveFrm("T_SNEAKTURNL",st);
     if(bool(wlkMode & WalkBit::WM_Walk))
       return solveFrm("T_%sWALKTURNL",st);
     if(bool(wlkMode & WalkBit::WM_Water))
@@ -223,11 +249,11 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
     }
   if(a==RotR) {
     if(bool(wlkMode & WalkBit::WM_Dive))
-      return solveFrm("T_DIVETURNR");
+      return solveFrm("T_DIVETURNR",st);
     if(bool(wlkMode & WalkBit::WM_Swim))
-      return solveFrm("T_SWIMTURNR");
+      return solveFrm("T_SWIMTURNR",st);
     if(bool(wlkMode & WalkBit::WM_Sneak))
-      return solveFrm("T_SNEAKTURNR");
+      return solveFrm("T_SNEAKTURNR",st);
     if(bool(wlkMode & WalkBit::WM_Walk))
       return solveFrm("T_%sWALKTURNR",st);
     if(bool(wlkMode & WalkBit::WM_Water))
@@ -237,47 +263,47 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
   // Jump regular
   if(a==Jump) {
     if(pose.isIdle())
-      return solveFrm("T_STAND_2_JUMP");
-    return solveFrm("S_JUMP");
+      return solveFrm("T_STAND_2_JUMP",st);
+    return solveFrm("S_JUMP",st);
     }
   if(a==JumpUpLow) {
     if(pose.isIdle())
-      return solveFrm("T_STAND_2_JUMPUPLOW");
-    return solveFrm("S_JUMPUPLOW");
+      return solveFrm("T_STAND_2_JUMPUPLOW",st);
+    return solveFrm("S_JUMPUPLOW",st);
     }
   if(a==JumpUpMid) {
     if(pose.isIdle())
-      return solveFrm("T_STAND_2_JUMPUPMID");
-    return solveFrm("S_JUMPUPMID");
+      return solveFrm("T_STAND_2_JUMPUPMID",st);
+    return solveFrm("S_JUMPUPMID",st);
     }
   if(a==JumpUp) {
     if(pose.isIdle())
-      return solveFrm("T_STAND_2_JUMPUP");
-    return solveFrm("S_JUMPUP");
+      return solveFrm("T_STAND_2_JUMPUP",st);
+    return solveFrm("S_JUMPUP",st);
     }
   if(a==JumpHang) {
     if(pose.bodyState()==BS_JUMP)  {
-      if(auto ret = solveFrm("T_JUMPUP_2_HANG"))
+      if(auto ret = solveFrm("T_JUMPUP_2_HANG",st))
         return ret;
       }
-    //return solveFrm("S_HANG");
-    return solveFrm("T_HANG_2_STAND");
+    //return solveFrm("S_HANG",st);
+    return solveFrm("T_HANG_2_STAND",st);
     }
 
   if(a==Anim::Fallen)
-    return solveFrm("S_FALLEN"); //TODO: S_FALLENB
+    return solveFrm("S_FALLEN",st); //TODO: S_FALLENB
   if(a==Anim::Fall)
-    return solveFrm("S_FALLDN");
+    return solveFrm("S_FALLDN",st);
   if(a==Anim::FallDeep)
-    return solveFrm("S_FALL");
+    return solveFrm("S_FALL",st);
   if(a==Anim::SlideA)
-    return solveFrm("S_SLIDE");
+    return solveFrm("S_SLIDE",st);
   if(a==Anim::SlideB)
-    return solveFrm("S_SLIDEB");
+    return solveFrm("S_SLIDEB",st);
   if(a==Anim::StumbleA)
-    return solveFrm("T_STUMBLE");
+    return solveFrm("T_STUMBLE",st);
   if(a==Anim::StumbleB)
-    return solveFrm("T_STUMBLEB");
+    return solveFrm("T_STUMBLEB",st);
   if(a==Anim::DeadA) {
     if(pose.isInAnim("S_WOUNDED")  || pose.isInAnim("T_STAND_2_WOUNDED") ||
        pose.isInAnim("S_WOUNDEDB") || pose.isInAnim("T_STAND_2_WOUNDEDB"))
@@ -297,14 +323,14 @@ const Animation::Sequence* AnimationSolver::solveAnim(AnimationSolver::Anim a, W
       return solveDead("S_DEADB","S_DEAD");
     }
   if(a==Anim::UnconsciousA)
-    return solveFrm("T_STAND_2_WOUNDED");
+    return solveFrm("T_STAND_2_WOUNDED",st);
   if(a==Anim::UnconsciousB)
-    return solveFrm("T_STAND_2_WOUNDEDB");
+    return solveFrm("T_STAND_2_WOUNDEDB",st);
 
   if(a==Anim::ItmGet)
-    return solveFrm("S_IGET");
+    return solveFrm("S_IGET",st);
   if(a==Anim::ItmDrop)
-    return solveFrm("S_IDROP");
+    return solveFrm("S_IDROP",st);
 
   return nullptr;
   }
@@ -348,7 +374,73 @@ const Animation::Sequence *AnimationSolver::solveAnim(Interactive *inter, Animat
     }
   }
 
-const Animation::Sequence *AnimationSolver::solveFrm(const char *format, WeaponState st) const {
+const Animation::Sequence* AnimationSolver::solveTransition(const Animation::Sequence& from, const Animation::Sequence& to) const {
+  CacheKey key;
+  key.a = &from;
+  key.b = &to;
+  auto it = cache.find(key);
+  if(it!=cache.end())
+    return it->second;
+
+  char tansition[256]={};
+  const Animation::Sequence* tr=nullptr;
+  if(from.shortName!=nullptr && to.shortName!=nullptr) {
+    std::snprintf(tansition,sizeof(tansition),"T_%s_2_%s",from.shortName,to.shortName);
+    tr = solveFrm(tansition);
+    }
+  if(tr==nullptr && to.shortName!=nullptr) {
+    std::snprintf(tansition,sizeof(tansition),"T_STAND_2_%s",to.shortName);
+    tr = solveFrm(tansition);
+    }
+  if(tr==nullptr && from.shortName!=nullptr && to.isIdle()) {
+    std::snprintf(tansition,sizeof(tansition),"T_%s_2_STAND",from.shortName);
+    tr = solveFrm(tansition);
+    }
+  cache[key] = tr;
+  return tr;
+  }
+
+const Animation::Sequence* AnimationSolver::solveItemUse(const Animation::Sequence& sq, int stA, int stB, bool toStand) const {
+  CacheKey key;
+  key.a = &sq;
+  key.c = (uint32_t(uint16_t(stA))<<16) | (uint32_t(uint8_t(stB))<<8) | (toStand ? 1u : 0u) | 0x80000000u;
+  auto it = cache.find(key);
+  if(it!=cache.end())
+    return it->second;
+
+  char scheme[64]={};
+  sq.schemeName(scheme);
+
+  const Animation::Sequence* ret = nullptr;
+  if(toStand) {
+    char T_ID_SX_2_STAND[128]={};
+    std::snprintf(T_ID_SX_2_STAND,sizeof(T_ID_SX_2_STAND),"T_%s_S%d_2_STAND",scheme,stA);
+    ret = solveFrm(T_ID_SX_2_STAND);
+    }
+
+  if(ret==nullptr) {
+    char T_ID_Sa_2_Sb[256]={};
+    std::snprintf(T_ID_Sa_2_Sb,sizeof(T_ID_Sa_2_Sb),"T_%s_S%d_2_S%d",scheme,stA,stB);
+    ret = solveFrm(T_ID_Sa_2_Sb);
+    }
+  cache[key] = ret;
+  return ret;
+  }
+
+const Animation::Sequence* AnimationSolver::solveFrm(const char* format, WeaponState st) const {
+  // 'format' is always a string literal, so pointer is unique and stable
+  CacheKey key;
+  key.a = format;
+  key.c = uint32_t(st);
+  auto it = cache.find(key);
+  if(it!=cache.end())
+    return it->second;
+  auto ret = implSolveFrm(format,st);
+  cache[key] = ret;
+  return ret;
+  }
+
+const Animation::Sequence *AnimationSolver::implSolveFrm(const char *format, WeaponState st) const {
   static const char* weapon[] = {
     "",
     "FIST",
@@ -376,9 +468,9 @@ const Animation::Sequence* AnimationSolver::solveMag(const char *format, const s
   }
 
 const Animation::Sequence *AnimationSolver::solveDead(const char *format1, const char *format2) const {
-  if(auto a=solveFrm(format1))
+  if(auto a=solveFrm(format1,WeaponState::NoWeapon))
     return a;
-  return solveFrm(format2);
+  return solveFrm(format2,WeaponState::NoWeapon);
   }
 
 const Animation::Sequence* AnimationSolver::solveNext(const Animation::Sequence& sq) const {
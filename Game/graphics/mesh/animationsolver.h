@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Tempest/Matrix4x4>
+#include <unordered_map>
 #include <vector>
 
 #include "graphics/meshobjects.h"
@@ -88,13 +89,31 @@ class AnimationSolver final {
     const Animation::Sequence*     solveAnim(Anim a, WeaponState st, WalkBit wlk, const Pose &pose) const;
     const Animation::Sequence*     solveAnim(WeaponState st, WeaponState cur, bool run) const;
     const Animation::Sequence*     solveAnim(Interactive *inter, Anim a, const Pose &pose) const;
+    const Animation::Sequence*     solveTransition(const Animation::Sequence& from, const Animation::Sequence& to) const;
+    const Animation::Sequence*     solveItemUse(const Animation::Sequence& sq, int stA, int stB, bool toStand) const;
 
   private:
+    // resolved sequences are memoized per solver; key is either a format-literal + weapon,
+    // or a pair of sequences. Cache is dropped, whenever set of overlays is changed
+    struct CacheKey final {
+      const void* a = nullptr;
+      const void* b = nullptr;
+      uint32_t    c = 0;
+      bool operator == (const CacheKey& k) const { return a==k.a && b==k.b && c==k.c; }
+      };
+    struct CacheHash final {
+      size_t operator()(const CacheKey& k) const;
+      };
+
     const Animation::Sequence*     solveFrm    (const char *format, WeaponState st) const;
+    const Animation::Sequence*     implSolveFrm(const char *format, WeaponState st) const;
+    void                           invalidateCache();
 
     const Animation::Sequence*     solveMag    (const char *format, const std::string& spell) const;
     const Animation::Sequence*     solveDead   (const char *format1, const char *format2) const;
 
     const Skeleton*                baseSk=nullptr;
     std::vector<Overlay>           overlay;
+
+    mutable std::unordered_map<CacheKey,const Animation::Sequence*,CacheHash> cache;
   };
@@ -1,5 +1,6 @@
 #include "animmath.h"
 
+#include <algorithm>
 #include <cmath>
 
 static float mix(float x,float y,float a){
@@ -95,3 +96,57 @@ Tempest::Matrix4x4 mkMatrix(const ZenLoad::zCModelAniSample& s) {
   return mkMatrix(s.rotation.x,s.rotation.y,s.rotation.z,s.rotation.w,
                   s.position.x,s.position.y,s.position.z);
   }
+
+void mixSamples(const Animation::Samples& s, size_t frameA, size_t frameB, size_t count, float a,
+                const uint32_t* nodeIndex, Tempest::Matrix4x4* out) {
+  enum { Chunk = 16 };
+  float qx[Chunk], qy[Chunk], qz[Chunk], qw[Chunk];
+  float px[Chunk], py[Chunk], pz[Chunk];
+
+  const float at = a-0.5f;
+  const float a1 = 1.f-a;
+
+  for(size_t b=0; b<count; b+=Chunk) {
+    const size_t n  = std::min<size_t>(Chunk,count-b);
+    const size_t iA = frameA*count+b;
+    const size_t iB = frameB*count+b;
+
+    const float* ax  = &s.qx[iA]; const float* bx  = &s.qx[iB];
+    const float* ay  = &s.qy[iA]; const float* by  = &s.qy[iB];
+    const float* az  = &s.qz[iA]; const float* bz  = &s.qz[iB];
+    const float* aw  = &s.qw[iA]; const float* bw  = &s.qw[iB];
+    const float* apx = &s.px[iA]; const float* bpx = &s.px[iB];
+    const float* apy = &s.py[iA]; const float* bpy = &s.py[iB];
+    const float* apz = &s.pz[iA]; const float* bpz = &s.pz[iB];
+
+    // branch-free slerp approximation: nlerp with polynomial correction of 't',
+    // to compensate non-uniform angular speed of plain nlerp
+    for(size_t i=0; i<n; ++i) {
+      const float dot = ax[i]*bx[i] + ay[i]*by[i] + az[i]*bz[i] + aw[i]*bw[i];
+      const float d   = std::fabs(dot);
+      const float ka  = 1.0904f + d*(-3.2452f + d*(3.55645f - d*1.43519f));
+      const float kb  = 0.848013f + d*(-1.06021f + d*0.215638f);
+      const float k   = ka*at*at + kb;
+      const float ot  = a + a*at*(a-1.f)*k;
+      const float t0  = 1.f-ot;
+      const float t1  = dot<0 ? -ot : ot;
+
+      const float x   = ax[i]*t0 + bx[i]*t1;
+      const float y   = ay[i]*t0 + by[i]*t1;
+      const float z   = az[i]*t0 + bz[i]*t1;
+      const float w   = aw[i]*t0 + bw[i]*t1;
+      const float l   = 1.f/std::sqrt(x*x + y*y + z*z + w*w);
+      qx[i] = x*l;
+      qy[i] = y*l;
+      qz[i] = z*l;
+      qw[i] = w*l;
+
+      px[i] = apx[i]*a1 + bpx[i]*a;
+      py[i] = apy[i]*a1 + bpy[i]*a;
+      pz[i] = apz[i]*a1 + bpz[i]*a;
+      }
+
+    for(size_t i=0; i<n; ++i)
+      out[nodeIndex[b+i]] = mkMatrix(qx[i],qy[i],qz[i],qw[i],px[i],py[i],pz[i]);
+    }
+  }
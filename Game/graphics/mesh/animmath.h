@@ -4,5 +4,11 @@
 #include <Tempest/Matrix4x4>
 #include <Tempest/Point>
 
+#include "animation.h"
+
 ZenLoad::zCModelAniSample mix(const ZenLoad::zCModelAniSample& x,const ZenLoad::zCModelAniSample& y,float a);
 Tempest::Matrix4x4        mkMatrix(const ZenLoad::zCModelAniSample& s);
+
+// interpolates 'count' nodes between two frames; out[nodeIndex[i]] receives the resulting local transform
+void                      mixSamples(const Animation::Samples& s, size_t frameA, size_t frameB, size_t count, float a,
+                                     const uint32_t* nodeIndex, Tempest::Matrix4x4* out);
@@ -19,6 +19,11 @@ Landscape::Landscape(WorldView& owner, VisualObjects& visual, const PackedMesh &
   Matrix4x4 ident;
   ident.identity();
 
+  std::vector<std::string> tex;
+  for(auto& i:mesh.subMeshes)
+    tex.push_back(i.material.texture);
+  Resources::preloadTextures(tex);
+
   for(auto& i:mesh.subMeshes) {
     auto material = Resources::loadMaterial(i.material,true);
     if(material.alpha==Material::AdditiveLight || i.indices.size()==0)
@@ -34,8 +39,9 @@ Landscape::Landscape(WorldView& owner, VisualObjects& visual, const PackedMesh &
     bbox.assign(mesh.vertices,i.indices);
     blocks.emplace_back();
     auto& b = blocks.back();
-    b.ibo  = Resources::ibo(i.indices.data(),i.indices.size());
-    b.mesh = visual.get(vbo,b.ibo,material,bbox);
+    b.ibo      = Resources::ibo(i.indices.data(),i.indices.size());
+    b.clusters = i.clusters;
+    b.mesh     = visual.get(vbo,b.ibo,material,bbox,b.clusters);
     b.mesh.setObjMatrix(ident);
     }
   }
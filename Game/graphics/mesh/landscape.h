@@ -6,6 +6,7 @@
 
 #include <zenload/zTypes.h>
 
+#include "graphics/mesh/submesh/packedmesh.h"
 #include "graphics/bounds.h"
 #include "graphics/material.h"
 #include "graphics/meshobjects.h"
@@ -14,7 +15,6 @@
 class World;
 class SceneGlobals;
 class LightSource;
-class PackedMesh;
 class WorldView;
 
 class Landscape final {
@@ -25,8 +25,9 @@ class Landscape final {
     using Item = ObjectsBucket::Item;
 
     struct Block {
-      Tempest::IndexBuffer<uint32_t> ibo;
-      Item                           mesh;
+      Tempest::IndexBuffer<uint32_t>   ibo;
+      std::vector<PackedMesh::Cluster> clusters;
+      Item                             mesh;
       };
 
     WorldView&                               owner;
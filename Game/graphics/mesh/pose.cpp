@@ -59,6 +59,7 @@ void Pose::load(Serialize &fin,const AnimationSolver& solver) {
     i.seq = solver.solveFrm(name.c_str());
     }
   fin.read(lastUpdate);
+  lastEvent = lastUpdate;
   if(fin.version()>=13) {
     fin.read(base,tr);
     if(skeleton!=nullptr) {
@@ -107,6 +108,7 @@ void Pose::setSkeleton(const Skeleton* sk) {
     base[i] = skeleton->nodes[i].tr;
 
   trY = skeleton->rootTr[1];
+  frameKey = 0;
 
   if(lay.size()>0) //TODO
     Log::d("WARNING: ",__func__," animation adjustment not implemented");
@@ -134,20 +136,7 @@ bool Pose::startAnim(const AnimationSolver& solver, const Animation::Sequence *s
         stopItemStateAnim(solver,tickCount);
         return false;
         }
-      char tansition[256]={};
-      const Animation::Sequence* tr=nullptr;
-      if(i.seq->shortName!=nullptr && sq->shortName!=nullptr) {
-        std::snprintf(tansition,sizeof(tansition),"T_%s_2_%s",i.seq->shortName,sq->shortName);
-        tr = solver.solveFrm(tansition);
-        }
-      if(tr==nullptr && sq->shortName!=nullptr) {
-        std::snprintf(tansition,sizeof(tansition),"T_STAND_2_%s",sq->shortName);
-        tr = solver.solveFrm(tansition);
-        }
-      if(tr==nullptr && i.seq->shortName!=nullptr && sq->isIdle()) {
-        std::snprintf(tansition,sizeof(tansition),"T_%s_2_STAND",i.seq->shortName);
-        tr = solver.solveFrm(tansition);
-        }
+      const Animation::Sequence* tr = solver.solveTransition(*i.seq,*sq);
       onRemoveLayer(i);
       i.seq   = tr ? tr : sq;
       i.sAnim = tickCount;
@@ -263,13 +252,22 @@ bool Pose::update(uint64_t tickCount) {
     }
 
   if(lastUpdate!=tickCount) {
+    // skip evaluation, if every layer is sampled at the same frames as before (finished transitions)
+    uint64_t key = lay.size();
     for(auto& i:lay) {
-      const Animation::Sequence* seq = i.seq;
-      if(0<i.comb && size_t(i.comb)<=i.seq->comb.size()) {
-        if(auto sx = i.seq->comb[size_t(i.comb-1)])
-          seq = sx;
-        }
-      needToUpdate |= updateFrame(*seq,lastUpdate,i.sAnim,tickCount);
+      auto&    seq = layerSequence(i);
+      uint64_t frameA=0, frameB=0;
+      float    a=0;
+      if(!selectFrame(seq,i.sAnim,tickCount,frameA,frameB,a))
+        continue;
+      const uint64_t k = frameA==frameB ? frameA : ((frameA<<32) | (frameB<<16) | uint64_t(a*1000.f));
+      key = (key ^ reinterpret_cast<uintptr_t>(&seq) ^ (uint64_t(i.bs)<<48) ^ k)*0x100000001b3ull;
+      }
+
+    if(key!=frameKey) {
+      frameKey = key;
+      for(auto& i:lay)
+        needToUpdate |= updateFrame(layerSequence(i),lastUpdate,i.sAnim,tickCount);
       }
     lastUpdate = tickCount;
     }
@@ -282,23 +280,43 @@ bool Pose::update(uint64_t tickCount) {
   return false;
   }
 
+const Animation::Sequence& Pose::layerSequence(const Layer& l) {
+  if(0<l.comb && size_t(l.comb)<=l.seq->comb.size()) {
+    if(auto sx = l.seq->comb[size_t(l.comb-1)])
+      return *sx;
+    }
+  return *l.seq;
+  }
+
 bool Pose::updateFrame(const Animation::Sequence &s,
                        uint64_t barrier, uint64_t sTime, uint64_t now) {
+  (void)barrier;
+  uint64_t frameA=0, frameB=0;
+  float    a=0;
+  if(!selectFrame(s,sTime,now,frameA,frameB,a))
+    return false;
+
+  auto& d = *s.data;
+  mixSamples(d.samples,size_t(frameA),size_t(frameB),d.nodeIndex.size(),a,d.nodeIndex.data(),base.data());
+  return true;
+  }
+
+bool Pose::selectFrame(const Animation::Sequence& s, uint64_t sTime, uint64_t now,
+                       uint64_t& frameA, uint64_t& frameB, float& a) {
   auto&        d         = *s.data;
   const size_t numFrames = d.numFrames;
   const size_t idSize    = d.nodeIndex.size();
   if(numFrames==0 || idSize==0 || d.samples.size()%idSize!=0)
     return false;
 
-  (void)barrier;
   now = now-sTime;
 
   float    fpsRate = d.fpsRate;
   uint64_t frame   = uint64_t(float(now)*fpsRate);
-  uint64_t frameA  = frame/1000;
-  uint64_t frameB  = frame/1000+1; //next
+  frameA  = frame/1000;
+  frameB  = frame/1000+1; //next
 
-  float    a       = float(frame%1000)/1000.f;
+  a       = float(frame%1000)/1000.f;
 
   if(s.animCls==Animation::Loop){
     frameA%=d.numFrames;
@@ -312,14 +330,6 @@ bool Pose::updateFrame(const Animation::Sequence &s,
     frameA = d.numFrames-1-frameA;
     frameB = d.numFrames-1-frameB;
     }
-
-  auto* sampleA = &d.samples[size_t(frameA*idSize)];
-  auto* sampleB = &d.samples[size_t(frameB*idSize)];
-
-  for(size_t i=0;i<idSize;++i) {
-    auto smp = mix(sampleA[i],sampleB[i],a);
-    base[d.nodeIndex[i]] = mkMatrix(smp);
-    }
   return true;
   }
 
@@ -327,33 +337,18 @@ void Pose::mkSkeleton(const Animation::Sequence &s, BodyState bs) {
   if(skeleton==nullptr)
     return;
   Matrix4x4 m = mkBaseTranslation(&s,bs);
-  if(skeleton->ordered)
-    mkSkeleton(m); else
-    mkSkeleton(m,size_t(-1));
+  mkSkeleton(m);
   }
 
 void Pose::mkSkeleton(const Matrix4x4 &mt) {
   if(skeleton==nullptr)
     return;
-  auto& nodes=skeleton->nodes;
-  for(size_t i=0; i<nodes.size(); ++i) {
-    if(nodes[i].parent==size_t(-1)) {
-      tr[i] = mt*base[i];
-      } else {
-      tr[i] = tr[nodes[i].parent]*base[i];
-      }
-    }
-  }
-
-void Pose::mkSkeleton(const Tempest::Matrix4x4 &mt, size_t parent) {
-  if(skeleton==nullptr)
-    return;
-  auto& nodes=skeleton->nodes;
-  for(size_t i=0;i<nodes.size();++i){
-    if(nodes[i].parent!=parent)
-      continue;
-    tr[i] = mt*base[i];
-    mkSkeleton(tr[i],i);
+  auto& nodes = skeleton->nodes;
+  for(size_t i:skeleton->order) {
+    const size_t parent = nodes[i].parent;
+    if(parent==size_t(-1))
+      tr[i] = mt*base[i]; else
+      tr[i] = tr[parent]*base[i];
     }
   }
 
@@ -361,7 +356,7 @@ const Animation::Sequence* Pose::getNext(const AnimationSolver &solver, const La
   auto sq = lay.seq;
 
   if((lay.bs & BS_ITEMINTERACT)==BS_ITEMINTERACT && itemUseSt!=itemUseDestSt) {
-    int sA = itemUseSt, sB = itemUseSt, nextState = itemUseSt;
+    int sB = itemUseSt, nextState = itemUseSt;
     if(itemUseSt<itemUseDestSt) {
       sB++;
       nextState = itemUseSt+1;
@@ -369,22 +364,7 @@ const Animation::Sequence* Pose::getNext(const AnimationSolver &solver, const La
       sB--;
       nextState = itemUseSt-1;
       }
-    char scheme[64]={};
-    sq->schemeName(scheme);
-
-    const Animation::Sequence* ret = nullptr;
-    if(itemUseSt>itemUseDestSt) {
-      char T_ID_SX_2_STAND[128]={};
-      std::snprintf(T_ID_SX_2_STAND,sizeof(T_ID_SX_2_STAND),"T_%s_S%d_2_STAND",scheme,itemUseSt);
-      ret = solver.solveFrm(T_ID_SX_2_STAND);
-      }
-
-    if(ret==nullptr) {
-      char T_ID_Sa_2_Sb[256]={};
-      std::snprintf(T_ID_Sa_2_Sb,sizeof(T_ID_Sa_2_Sb),"T_%s_S%d_2_S%d",scheme,sA,sB);
-      ret = solver.solveFrm(T_ID_Sa_2_Sb);
-      }
-
+    const Animation::Sequence* ret = solver.solveItemUse(*sq,itemUseSt,sB,itemUseSt>itemUseDestSt);
     if(ret==nullptr && itemUseDestSt>=0)
       return sq;
     itemUseSt = nextState;
@@ -415,12 +395,12 @@ void Pose::onRemoveLayer(Pose::Layer &l) {
 
 void Pose::processSfx(Npc &npc, uint64_t tickCount) {
   for(auto& i:lay)
-    i.seq->processSfx(lastUpdate,i.sAnim,tickCount,npc);
+    i.seq->processSfx(lastEvent,i.sAnim,tickCount,npc);
   }
 
 void Pose::processPfx(MdlVisual& visual, World& world, uint64_t tickCount) {
   for(auto& i:lay)
-    i.seq->processPfx(lastUpdate,i.sAnim,tickCount,visual,world);
+    i.seq->processPfx(lastEvent,i.sAnim,tickCount,visual,world);
   }
 
 void Pose::processEvents(uint64_t &barrier, uint64_t now, Animation::EvCount &ev) const {
@@ -50,6 +50,8 @@ class Pose final {
     Tempest::Vec3      animMoveSpeed(uint64_t tickCount, uint64_t dt) const;
     void               processSfx(Npc &npc, uint64_t tickCount);
     void               processPfx(MdlVisual& visual, World& world, uint64_t tickCount);
+    // sfx/pfx events are processed every tick, even if pose itself is not evaluated
+    void               commitEvents(uint64_t tickCount) { lastEvent = tickCount; }
     void               processEvents(uint64_t& barrier, uint64_t now, Animation::EvCount &ev) const;
     bool               isDefParWindow(uint64_t tickCount) const;
     bool               isDefWindow(uint64_t tickCount) const;
@@ -64,6 +66,7 @@ class Pose final {
     bool               isInAnim(const Animation::Sequence* sq) const;
     bool               hasAnim() const;
     uint64_t           animationTotalTime() const;
+    uint64_t           lastUpdateTime() const { return lastUpdate; }
 
     auto               continueCombo(const AnimationSolver &solver,const Animation::Sequence *sq,uint64_t tickCount) -> const Animation::Sequence*;
     uint32_t           comboLength() const;
@@ -90,10 +93,11 @@ class Pose final {
     auto mkBaseTranslation(const Animation::Sequence *s, BodyState bs) -> Tempest::Matrix4x4;
     void mkSkeleton(const Animation::Sequence &s, BodyState bs);
     void mkSkeleton(const Tempest::Matrix4x4 &mt);
-    void mkSkeleton(const Tempest::Matrix4x4 &mt, size_t parent);
     void zeroSkeleton();
 
     bool updateFrame(const Animation::Sequence &s, uint64_t barrier, uint64_t sTime, uint64_t now);
+    static bool selectFrame(const Animation::Sequence& s, uint64_t sTime, uint64_t now, uint64_t& frameA, uint64_t& frameB, float& a);
+    static auto layerSequence(const Layer& l) -> const Animation::Sequence&;
 
     const Animation::Sequence* getNext(const AnimationSolver& solver, const Layer& lay);
 
@@ -113,6 +117,8 @@ class Pose final {
     float                           trY=0;
     Flags                           flag=NoFlags;
     uint64_t                        lastUpdate=0;
+    uint64_t                        lastEvent=0;
+    uint64_t                        frameKey=0;
     uint16_t                        comboLen=0;
     bool                            needToUpdate = true;
 
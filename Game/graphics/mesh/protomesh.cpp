@@ -14,6 +14,7 @@ ProtoMesh::ProtoMesh(const ZenLoad::zCModelMeshLib &library, const std::string &
     attach.emplace_back(stat);
     auto& att = attach.back();
     att.name = m.first;
+    att.setSource(fname,m.first);
     att.shape.reset(PhysicMeshShape::load(std::move(stat)));
     }
 
@@ -89,6 +90,7 @@ ProtoMesh::ProtoMesh(ZenLoad::PackedMesh&& pm, const std::string& fname) {
   attach.emplace_back(pm);
   submeshId.resize(attach[0].sub.size());
   auto&  att   = attach[0];
+  att.setSource(fname,"");
   att.shape.reset(PhysicMeshShape::load(std::move(pm)));
 
   size_t count = 0;
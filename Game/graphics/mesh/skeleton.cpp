@@ -34,6 +34,7 @@ Skeleton::Skeleton(const ZenLoad::zCModelMeshLib &src, std::string meshLib)
   for(size_t i=0;i<nodes.size();++i)
     if(nodes[i].parent==size_t(-1))
       rootNodes.push_back(i);
+  mkOrder();
 
   anim = Resources::loadAnimation(this->meshLib);
 
@@ -81,6 +82,22 @@ float Skeleton::colisionRadius() const {
   return std::max(x,y); //TODO
   }
 
+void Skeleton::mkOrder() {
+  order.reserve(nodes.size());
+  if(ordered) {
+    for(size_t i=0;i<nodes.size();++i)
+      order.push_back(i);
+    return;
+    }
+  order = rootNodes;
+  for(size_t r=0;r<order.size();++r) {
+    const size_t parent = order[r];
+    for(size_t i=0;i<nodes.size();++i)
+      if(nodes[i].parent==parent)
+        order.push_back(i);
+    }
+  }
+
 void Skeleton::mkSkeleton() {
   Matrix4x4 m;
   m.identity();
@@ -21,6 +21,7 @@ class Skeleton final {
     bool                            ordered=true;
     std::vector<Node>               nodes;
     std::vector<size_t>             rootNodes;
+    std::vector<size_t>             order; // parent-first traversal of nodes
     std::vector<Tempest::Matrix4x4> tr;
     std::array<float,3>             rootTr={};
 
@@ -41,6 +42,7 @@ class Skeleton final {
     std::string      meshLib;
     const Animation* anim=nullptr;
 
+    void mkOrder();
     void mkSkeleton();
     void mkSkeleton(const Tempest::Matrix4x4& mt,size_t parent);
   };
@@ -2,10 +2,15 @@
 
 #include <Tempest/Log>
 
+#include "vertexcodec.h"
+
 AnimMesh::AnimMesh(const ZenLoad::PackedSkeletalMesh &mesh) {
-  static_assert(sizeof(VertexA)==sizeof(mesh.vertices[0]),"invalid VertexA size");
-  const VertexA* vert = reinterpret_cast<const VertexA*>(mesh.vertices.data());
-  vbo = Resources::vbo(vert,mesh.vertices.size());
+  static_assert(sizeof(VertexCodec::Skinned)==sizeof(mesh.vertices[0]),"invalid SkeletalVertex size");
+  auto                 src = reinterpret_cast<const VertexCodec::Skinned*>(mesh.vertices.data());
+  std::vector<VertexA> cvbo(mesh.vertices.size());
+  for(size_t i=0;i<cvbo.size();++i)
+    cvbo[i] = VertexCodec::pack(src[i]);
+  vbo = Resources::vbo(cvbo.data(),cvbo.size());
 
   sub.resize(mesh.subMeshes.size());
   for(size_t i=0;i<mesh.subMeshes.size();++i){
@@ -1,19 +1,72 @@
 #include "packedmesh.h"
 
 #include <Tempest/Log>
+#include <Tempest/Point>
 
 #include <algorithm>
+#include <cmath>
 
-#include "graphics/bounds.h"
+#include "utils/workers.h"
 
 using namespace Tempest;
 
+namespace {
+
+// open-addressing map: (position, feature) -> vertex id
+class VertexDedup final {
+  public:
+    explicit VertexDedup(size_t count) {
+      size_t cap = 16;
+      while(cap<count*2)
+        cap <<= 1;
+      key.resize(cap);
+      val.resize(cap,uint32_t(-1));
+      mask = cap-1;
+      }
+
+    // returns id of existing entry, or inserts a new one with value `id`
+    uint32_t insert(uint64_t k, uint32_t id) {
+      size_t at = size_t(mix(k)) & mask;
+      while(val[at]!=uint32_t(-1)) {
+        if(key[at]==k)
+          return val[at];
+        at = (at+1) & mask;
+        }
+      key[at] = k;
+      val[at] = id;
+      return id;
+      }
+
+  private:
+    // splitmix64 finalizer: neighbour ids land far apart
+    static uint64_t mix(uint64_t v) {
+      v ^= v >> 30;
+      v *= 0xbf58476d1ce4e5b9ull;
+      v ^= v >> 27;
+      v *= 0x94d049bb133111ebull;
+      v ^= v >> 31;
+      return v;
+      }
+
+    std::vector<uint64_t> key;
+    std::vector<uint32_t> val;
+    size_t                mask = 0;
+  };
+
+float dot(const Vec3& a, const Vec3& b) {
+  return a.x*b.x + a.y*b.y + a.z*b.z;
+  }
+
+}
+
 PackedMesh::PackedMesh(const ZenLoad::zCMesh& mesh, PkgType type) {
   mesh.getBoundingBox(bbox[0],bbox[1]);
   if(type==PK_Visual || type==PK_VisualLnd) {
     subMeshes.resize(mesh.getMaterials().size());
-    for(size_t i=0;i<subMeshes.size();++i)
+    for(size_t i=0;i<subMeshes.size();++i) {
       subMeshes[i].material = mesh.getMaterials()[i];
+      subMeshes[i].matIndex = i;
+      }
     }
 
   if(type==PK_Physic) {
@@ -38,19 +91,18 @@ PackedMesh::PackedMesh(const ZenLoad::zCMesh& mesh, PkgType type) {
     }
 
   pack(mesh,type);
-  if(type==PK_VisualLnd)
+  if(type==PK_VisualLnd) {
     landRepack();
+    for(auto& i:subMeshes)
+      mkClusters(i,0,i.indices.size());
+    }
   }
 
 void PackedMesh::pack(const ZenLoad::zCMesh& mesh,PkgType type) {
   auto& vbo = mesh.getVertices();
   auto& uv  = mesh.getFeatureIndices();
   auto& ibo = mesh.getIndices();
-
-  vertices.reserve(vbo.size());
-
-  size_t prevTriId = size_t(-1);
-  size_t matId     = 0;
+  auto& mid = mesh.getTriangleMaterialIndices();
 
   std::vector<SubMesh*> index;
   if(type==PK_PhysicZoned) {
@@ -61,44 +113,89 @@ void PackedMesh::pack(const ZenLoad::zCMesh& mesh,PkgType type) {
       });
     }
 
-  struct Hash final {
-    size_t operator() (const std::pair<uint32_t,uint32_t>& v) const noexcept {
-      return v.first^v.second;
-      }
-    };
-  std::unordered_map<std::pair<uint32_t,uint32_t>,size_t,Hash> icache;
-  auto& mid = mesh.getTriangleMaterialIndices();
-
-  for(size_t i=0;i<ibo.size();++i) {
-    size_t id    = size_t(mid[i/3]);
-
+  // bucket triangles by destination submesh; original order is preserved within a bucket
+  const size_t          triCount  = ibo.size()/3;
+  std::vector<uint32_t> triMat(triCount);
+  std::vector<size_t>   offset(subMeshes.size()+1,0);
+  size_t                prevTriId = size_t(-1);
+  size_t                matId     = 0;
+  for(size_t i=0;i<triCount;++i) {
+    size_t id = size_t(mid[i]);
     if(id!=prevTriId) {
-      matId     = submeshIndex(mesh,index,ibo[i],id,type);
+      matId     = submeshIndex(mesh,index,ibo[i*3],id,type);
       prevTriId = id;
       }
-
-    if(matId>=subMeshes.size())
+    if(matId>=subMeshes.size()) {
+      triMat[i] = uint32_t(-1);
       continue;
-    auto& s = subMeshes[matId];
+      }
+    triMat[i] = uint32_t(matId);
+    offset[matId+1]++;
+    }
+  for(size_t i=1;i<offset.size();++i)
+    offset[i] += offset[i-1];
+
+  std::vector<uint32_t> tri(offset.back());
+  std::vector<size_t>   at(offset.begin(),offset.end()-1);
+  for(size_t i=0;i<triCount;++i)
+    if(triMat[i]!=uint32_t(-1))
+      tri[at[triMat[i]]++] = uint32_t(i);
+
+  std::vector<PackTask> task(subMeshes.size());
+  for(size_t i=0;i<task.size();++i) {
+    task[i].sub   = &subMeshes[i];
+    task[i].tri   = tri.data()+offset[i];
+    task[i].count = offset[i+1]-offset[i];
+    }
 
-    std::pair<uint32_t,uint32_t> index={ibo[i], (type==PK_Physic ? 0 : uv[i])};
-    auto r = icache.find(index);
-    if(r!=icache.end()) {
-      s.indices.push_back(uint32_t(r->second));
-      } else {
-      auto&       v  = mesh.getFeatures()[index.second];
-      WorldVertex vx = {};
+  auto packSub = [&](PackTask& t, VertexDedup& icache, std::vector<WorldVertex>& vert) {
+    t.sub->indices.resize(t.count*3);
+    for(size_t i=0;i<t.count*3;++i) {
+      const size_t   src = size_t(t.tri[i/3])*3 + i%3;
+      const uint32_t pos = ibo[src];
+      const uint32_t ft  = (type==PK_Physic ? 0 : uv[src]);
+      const uint32_t id  = icache.insert((uint64_t(pos)<<32) | ft, uint32_t(vert.size()));
+      if(id==vert.size()) {
+        auto&       v  = mesh.getFeatures()[ft];
+        WorldVertex vx = {};
+
+        vx.Position = vbo[pos];
+        vx.Normal   = v.vertNormal;
+        vx.TexCoord = ZMath::float2(v.uv[0], v.uv[1]);
+        vx.Color    = v.lightStat;
+        vert.emplace_back(vx);
+        }
+      t.sub->indices[i] = id;
+      }
+    };
 
-      vx.Position = vbo[index.first];
-      vx.Normal   = v.vertNormal;
-      vx.TexCoord = ZMath::float2(v.uv[0], v.uv[1]);
-      vx.Color    = v.lightStat;
+  if(type==PK_Physic || type==PK_PhysicZoned) {
+    // collision triangles of different material groups share vertices: one table for whole mesh
+    VertexDedup icache(tri.size()*3);
+    for(auto& t:task)
+      packSub(t,icache,vertices);
+    return;
+    }
 
-      size_t val = vertices.size();
-      vertices.emplace_back(vx);
-      s.indices.push_back(uint32_t(val));
-      icache[index] = uint32_t(val);
-      }
+  // visual submeshes are deduplicated independently, so buckets can be packed concurrently
+  auto packVisual = [&](PackTask& t) {
+    VertexDedup icache(t.count*3);
+    packSub(t,icache,t.vert);
+    };
+  if(ibo.size()>=ParallelPackSize)
+    Workers::parallelFor(task,packVisual); else
+    for(auto& t:task)
+      packVisual(t);
+
+  size_t total = 0;
+  for(auto& t:task)
+    total += t.vert.size();
+  vertices.reserve(total);
+  for(auto& t:task) {
+    const uint32_t base = uint32_t(vertices.size());
+    for(auto& i:t.sub->indices)
+      i += base;
+    vertices.insert(vertices.end(),t.vert.begin(),t.vert.end());
     }
   }
 
@@ -163,28 +260,46 @@ void PackedMesh::landRepack() {
   for(auto& i:subMeshes) {
     if(i.indices.size()==0)
       continue;
-    split(m,i);
+    split(m,i,0,i.indices.size());
     }
 
   subMeshes = std::move(m);
   }
 
-void PackedMesh::split(std::vector<SubMesh>& out, SubMesh& src) {
+void PackedMesh::split(std::vector<SubMesh>& out, SubMesh& src, size_t begin, size_t end) {
+  // triangles are partitioned in place, inside of src.indices; only leaf ranges are copied out
+  auto leaf = [&]() {
+    out.emplace_back();
+    auto& m = out.back();
+    m.material = src.material;
+    m.matIndex = src.matIndex;
+    m.indices.assign(src.indices.begin()+ptrdiff_t(begin),src.indices.begin()+ptrdiff_t(end));
+    };
+
   static bool avoidMicroMeshes = true;
-  if(avoidMicroMeshes && src.indices.size()<2048*3) {
-    if(src.indices.size()>0)
-      out.push_back(std::move(src));
+  if(avoidMicroMeshes && end-begin<2048*3) {
+    leaf();
     return;
     }
 
-  Bounds bbox;
-  bbox.assign(vertices,src.indices);
-  Vec3 sz = bbox.bboxTr[1]-bbox.bboxTr[0];
+  uint32_t* ibo     = src.indices.data();
+  Vec3      bbox[2] = {};
+  for(size_t i=begin; i<end; ++i) {
+    auto& p = vertices[ibo[i]].Position;
+    if(i==begin) {
+      bbox[0] = Vec3(p.x,p.y,p.z);
+      bbox[1] = bbox[0];
+      continue;
+      }
+    bbox[0] = Vec3(std::min(bbox[0].x,p.x),std::min(bbox[0].y,p.y),std::min(bbox[0].z,p.z));
+    bbox[1] = Vec3(std::max(bbox[1].x,p.x),std::max(bbox[1].y,p.y),std::max(bbox[1].z,p.z));
+    }
+  Vec3 sz  = bbox[1]-bbox[0];
+  Vec3 mid = (bbox[0]+bbox[1])/2;
 
   static const float blockSz = 40*100;
   if(sz.x*sz.y*sz.z<blockSz*blockSz*blockSz) {
-    if(src.indices.size()>0)
-      out.push_back(std::move(src));
+    leaf();
     return;
     }
 
@@ -195,50 +310,155 @@ void PackedMesh::split(std::vector<SubMesh>& out, SubMesh& src) {
     axis = 2;
 
   for(int pass=0; pass<3; ++pass) {
-    SubMesh left, right;
-    left .material = src.material;
-    right.material = src.material;
-
-    for(size_t i=0; i<src.indices.size(); i+=3) {
-      auto& a = vertices[src.indices[i+0]].Position;
-      auto& b = vertices[src.indices[i+1]].Position;
-      auto& c = vertices[src.indices[i+2]].Position;
-
-      Vec3 at = {a.x+b.x+c.x, a.y+b.y+c.y, a.z+b.z+c.z};
-      at/=3;
-
-      bool  cond = false;
-      switch(axis) {
-        case 0:
-          cond = at.x < bbox.midTr.x;
-          break;
-        case 1:
-          cond = at.y < bbox.midTr.y;
-          break;
-        case 2:
-          cond = at.z < bbox.midTr.z;
-          break;
-        }
-      SubMesh& dest = cond ? left : right;
-      size_t i0 = dest.indices.size();
-      dest.indices.resize(dest.indices.size()+3);
-
-      for(int r=0;r<3;++r)
-        dest.indices[i0+r] = src.indices[i+r];
-      }
-    if((left.indices.size()==0 || right.indices.size()==0) && pass!=2) {
+    const size_t l = partition(ibo,begin,end,axis,axis==0 ? mid.x : (axis==1 ? mid.y : mid.z));
+    if((l==begin || l==end) && pass!=2) {
       axis = (axis+1)%3;
       continue;
       }
 
-    if(left.indices.size()==0 || right.indices.size()==0) {
-      out.push_back(std::move(src));
+    if(l==begin || l==end) {
+      leaf();
       return;
       }
-    src.indices.clear();
-    split(out,left);
-    split(out,right);
+    split(out,src,begin,l);
+    split(out,src,l,end);
     return;
     }
   }
 
+size_t PackedMesh::partition(uint32_t* ibo, size_t begin, size_t end, int axis, float mid) const {
+  // moves triangles with centroid below `mid` to front of the range; returns split point
+  auto isLeft = [&](size_t i) {
+    auto& a = vertices[ibo[i+0]].Position;
+    auto& b = vertices[ibo[i+1]].Position;
+    auto& c = vertices[ibo[i+2]].Position;
+    switch(axis) {
+      case 0:
+        return (a.x+b.x+c.x)/3.f < mid;
+      case 1:
+        return (a.y+b.y+c.y)/3.f < mid;
+      default:
+        return (a.z+b.z+c.z)/3.f < mid;
+      }
+    };
+
+  size_t l = begin, r = end;
+  while(l<r) {
+    if(isLeft(l)) {
+      l += 3;
+      } else {
+      r -= 3;
+      std::swap_ranges(ibo+l,ibo+l+3,ibo+r);
+      }
+    }
+  return l;
+  }
+
+void PackedMesh::mkClusters(SubMesh& sub, size_t begin, size_t end) {
+  if(end-begin<=ClusterSize*3) {
+    if(end>begin)
+      mkCluster(sub,begin,end);
+    return;
+    }
+
+  uint32_t* ibo     = sub.indices.data();
+  Vec3      bbox[2] = {};
+  for(size_t i=begin; i<end; i+=3) {
+    auto& a = vertices[ibo[i+0]].Position;
+    auto& b = vertices[ibo[i+1]].Position;
+    auto& c = vertices[ibo[i+2]].Position;
+    Vec3  p = Vec3(a.x+b.x+c.x, a.y+b.y+c.y, a.z+b.z+c.z)/3.f;
+    if(i==begin) {
+      bbox[0] = p;
+      bbox[1] = p;
+      continue;
+      }
+    bbox[0] = Vec3(std::min(bbox[0].x,p.x),std::min(bbox[0].y,p.y),std::min(bbox[0].z,p.z));
+    bbox[1] = Vec3(std::max(bbox[1].x,p.x),std::max(bbox[1].y,p.y),std::max(bbox[1].z,p.z));
+    }
+
+  Vec3 sz  = bbox[1]-bbox[0];
+  Vec3 mid = (bbox[0]+bbox[1])/2;
+  int  axis = 0;
+  if(sz.y>sz.x && sz.y>sz.z)
+    axis = 1;
+  if(sz.z>sz.x && sz.z>sz.y)
+    axis = 2;
+
+  size_t l = partition(ibo,begin,end,axis,axis==0 ? mid.x : (axis==1 ? mid.y : mid.z));
+  if(l==begin || l==end) {
+    // all centroids coincide - split by count
+    l = begin + ((end-begin)/6)*3;
+    }
+  mkClusters(sub,begin,l);
+  mkClusters(sub,l,end);
+  }
+
+void PackedMesh::mkCluster(SubMesh& sub, size_t begin, size_t end) {
+  const uint32_t* ibo     = sub.indices.data();
+  Vec3            bbox[2] = {};
+  for(size_t i=begin; i<end; ++i) {
+    auto& p = vertices[ibo[i]].Position;
+    if(i==begin) {
+      bbox[0] = Vec3(p.x,p.y,p.z);
+      bbox[1] = bbox[0];
+      continue;
+      }
+    bbox[0] = Vec3(std::min(bbox[0].x,p.x),std::min(bbox[0].y,p.y),std::min(bbox[0].z,p.z));
+    bbox[1] = Vec3(std::max(bbox[1].x,p.x),std::max(bbox[1].y,p.y),std::max(bbox[1].z,p.z));
+    }
+
+  Cluster c;
+  Vec3    at = (bbox[0]+bbox[1])/2;
+  float   r2 = 0;
+  for(size_t i=begin; i<end; ++i) {
+    auto& p = vertices[ibo[i]].Position;
+    Vec3  d = Vec3(p.x,p.y,p.z)-at;
+    r2 = std::max(r2,d.quadLength());
+    }
+  c.pos.x      = at.x;
+  c.pos.y      = at.y;
+  c.pos.z      = at.z;
+  c.r          = std::sqrt(r2);
+  c.firstIndex = uint32_t(begin);
+  c.indexCount = uint32_t(end-begin);
+
+  // normal cone: face normals, oriented by vertex normals, as those are consistent across the world
+  std::vector<Vec3> fn;
+  Vec3              axis = Vec3();
+  fn.reserve((end-begin)/3);
+  for(size_t i=begin; i<end; i+=3) {
+    auto& a  = vertices[ibo[i+0]];
+    auto& b  = vertices[ibo[i+1]];
+    auto& cv = vertices[ibo[i+2]];
+    Vec3  e0 = Vec3(b.Position.x-a.Position.x,  b.Position.y-a.Position.y,  b.Position.z-a.Position.z);
+    Vec3  e1 = Vec3(cv.Position.x-a.Position.x, cv.Position.y-a.Position.y, cv.Position.z-a.Position.z);
+    Vec3  n  = Vec3::crossProduct(e0,e1);
+    Vec3  vn = Vec3(a.Normal.x+b.Normal.x+cv.Normal.x, a.Normal.y+b.Normal.y+cv.Normal.y, a.Normal.z+b.Normal.z+cv.Normal.z);
+    float l  = std::sqrt(n.quadLength());
+    if(l<=0.f)
+      continue;
+    if(dot(n,vn)<0)
+      l = -l;
+    n /= l;
+    fn.push_back(n);
+    axis += n;
+    }
+
+  const float al = std::sqrt(axis.quadLength());
+  if(fn.empty() || al<=0.f) {
+    sub.clusters.push_back(c);
+    return;
+    }
+  axis /= al;
+
+  float minDot = 1.f;
+  for(auto& n:fn)
+    minDot = std::min(minDot,dot(n,axis));
+  c.coneAxis.x = axis.x;
+  c.coneAxis.y = axis.y;
+  c.coneAxis.z = axis.z;
+  if(minDot>0.f)
+    c.coneCutoff = std::sqrt(1.f-minDot*minDot);
+  sub.clusters.push_back(c);
+  }
@@ -7,6 +7,7 @@
 #include <map>
 
 class Bounds;
+class WorldCache;
 
 class PackedMesh {
   public:
@@ -20,9 +21,21 @@ class PackedMesh {
       PK_PhysicZoned
       };
 
+    // small, spatially coherent range of triangles; used for per-cluster culling of landscape
+    struct Cluster final {
+      ZMath::float3           pos;
+      float                   r          = 0;
+      ZMath::float3           coneAxis;
+      float                   coneCutoff = 2.f; // sin of normal spread; >1 - no backface culling
+      uint32_t                firstIndex = 0;
+      uint32_t                indexCount = 0;
+      };
+
     struct SubMesh final {
       ZenLoad::zCMaterialData material;
+      size_t                  matIndex = size_t(-1); // source material in zCMesh, if any
       std::vector<uint32_t>   indices;
+      std::vector<Cluster>    clusters;
       };
 
     std::vector<WorldVertex>   vertices;
@@ -32,6 +45,20 @@ class PackedMesh {
     PackedMesh(const ZenLoad::zCMesh& mesh, PkgType type);
 
   private:
+    enum {
+      ParallelPackSize = 64*1024, // index count, from which pack() is split across workers
+      ClusterSize      = 128,     // max triangles per landscape cluster
+      };
+
+    struct PackTask {
+      SubMesh*                 sub   = nullptr;
+      const uint32_t*          tri   = nullptr;
+      size_t                   count = 0;
+      std::vector<WorldVertex> vert;
+      };
+
+    PackedMesh()=default;
+
     void   pack(const ZenLoad::zCMesh& mesh,PkgType type);
 
     size_t submeshIndex(const ZenLoad::zCMesh& mesh, std::vector<SubMesh*>& index,
@@ -41,6 +68,12 @@ class PackedMesh {
     static bool compare(const ZenLoad::zCMaterialData& l, const ZenLoad::zCMaterialData& r);
 
     void   landRepack();
-    void   split(std::vector<SubMesh>& out, SubMesh& src);
+    void   split(std::vector<SubMesh>& out, SubMesh& src, size_t begin, size_t end);
+    size_t partition(uint32_t* ibo, size_t begin, size_t end, int axis, float mid) const;
+
+    void   mkClusters(SubMesh& sub, size_t begin, size_t end);
+    void   mkCluster (SubMesh& sub, size_t begin, size_t end);
+
+  friend class WorldCache;
   };
 
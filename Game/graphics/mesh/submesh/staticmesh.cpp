@@ -1,9 +1,12 @@
 #include "staticmesh.h"
 
+#include <mutex>
+
 StaticMesh::StaticMesh(const ZenLoad::PackedMesh &mesh) {
   static_assert(sizeof(Vertex)==sizeof(ZenLoad::WorldVertex),"invalid landscape vertex format");
   const Vertex* vert=reinterpret_cast<const Vertex*>(mesh.vertices.data());
   vbo = Resources::vbo<Vertex>(vert,mesh.vertices.size());
+  vertexCount = mesh.vertices.size();
 
   sub.resize(mesh.subMeshes.size());
   for(size_t i=0;i<mesh.subMeshes.size();++i){
@@ -51,3 +54,37 @@ StaticMesh::StaticMesh(const Material& mat, std::vector<Resources::Vertex> cvbo,
     }
   bbox.assign(cvbo);
   }
+
+void StaticMesh::setSource(const std::string& file, const std::string& attach) {
+  srcFile   = file;
+  srcAttach = attach;
+  }
+
+// meshes are shared between buckets: loader and render threads may ask for the same copy
+static std::mutex cpuSync;
+
+const StaticMesh::CpuCopy* StaticMesh::cpuCopy() const {
+  std::lock_guard<std::mutex> guard(cpuSync);
+  return cpu.get();
+  }
+
+const StaticMesh::CpuCopy* StaticMesh::loadCpuCopy() const {
+  std::lock_guard<std::mutex> guard(cpuSync);
+  if(cpu!=nullptr || cpuFailed || !isBatchable())
+    return cpu.get();
+
+  ZenLoad::PackedMesh mesh;
+  if(!Resources::loadPackedMesh(srcFile,srcAttach,mesh) ||
+     mesh.vertices.size()!=vertexCount || mesh.subMeshes.size()!=sub.size()) {
+    cpuFailed = true;
+    return nullptr;
+    }
+
+  const Vertex* vert = reinterpret_cast<const Vertex*>(mesh.vertices.data());
+  cpu.reset(new CpuCopy());
+  cpu->vbo.assign(vert,vert+mesh.vertices.size());
+  cpu->ibo.resize(mesh.subMeshes.size());
+  for(size_t i=0; i<mesh.subMeshes.size(); ++i)
+    cpu->ibo[i] = std::move(mesh.subMeshes[i].indices);
+  return cpu.get();
+  }
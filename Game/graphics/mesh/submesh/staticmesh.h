@@ -9,9 +9,15 @@
 
 #include "resources.h"
 
+#include <memory>
+
 class StaticMesh {
   public:
     using Vertex=Resources::Vertex;
+    enum {
+      CpuCopyMaxVertices = 1024,
+      };
+
     StaticMesh(const ZenLoad::PackedMesh& data);
     StaticMesh(const ZenLoad::PackedSkeletalMesh& data);
     StaticMesh(const Material& mat, std::vector<Resources::Vertex> vbo, std::vector<uint32_t> ibo);
@@ -24,7 +30,27 @@ class StaticMesh {
       std::string                    texName;
       };
 
+    // cpu copy, to merge repeated static objects in ObjectsBucket
+    struct CpuCopy final {
+      std::vector<Vertex>                vbo;
+      std::vector<std::vector<uint32_t>> ibo; // per submesh
+      };
+
     Tempest::VertexBuffer<Vertex>  vbo;
     std::vector<SubMesh>           sub;
     Bounds                         bbox;
+
+    // archive file and attachment name, mesh was loaded from; cpu copy is reloaded from there
+    void                           setSource(const std::string& file, const std::string& attach);
+    bool                           isBatchable() const { return !srcFile.empty() && vertexCount<=CpuCopyMaxVertices; }
+    // reloads source file on first call: only for meshes, that actually get batched; nullptr on failure
+    const CpuCopy*                 loadCpuCopy() const;
+    // no file io: nullptr, if cpu copy is not loaded yet
+    const CpuCopy*                 cpuCopy() const;
+
+  private:
+    std::string                    srcFile, srcAttach;
+    size_t                         vertexCount = 0;
+    mutable std::unique_ptr<CpuCopy> cpu;
+    mutable bool                   cpuFailed = false;
   };
@@ -0,0 +1,128 @@
+#include "vertexcodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+Resources::VertexA VertexCodec::pack(const Skinned& v) {
+  Resources::VertexA r = {};
+  r.norm  = encodeOct(v.norm);
+  r.uv[0] = toHalf(v.uv[0]);
+  r.uv[1] = toHalf(v.uv[1]);
+  r.color = v.color;
+  for(int i=0; i<4; ++i) {
+    for(int c=0; c<3; ++c)
+      r.pos[i][c] = toHalf(v.pos[i][c]);
+    r.boneId[i] = v.boneId[i];
+    }
+
+  // keep sum of weights at exactly 255, error goes to the biggest weight
+  int sum = 0, big = 0;
+  for(int i=0; i<4; ++i) {
+    float w = std::min(std::max(v.weights[i],0.f),1.f);
+    r.weights[i] = uint8_t(std::lround(w*255.f));
+    sum += r.weights[i];
+    if(r.weights[i]>r.weights[big])
+      big = i;
+    }
+  if(sum>0)
+    r.weights[big] = uint8_t(std::min(std::max(r.weights[big]+255-sum,0),255));
+  return r;
+  }
+
+VertexCodec::Skinned VertexCodec::unpack(const Resources::VertexA& v) {
+  Skinned r = {};
+  decodeOct(v.norm,r.norm);
+  r.uv[0] = fromHalf(v.uv[0]);
+  r.uv[1] = fromHalf(v.uv[1]);
+  r.color = v.color;
+  for(int i=0; i<4; ++i) {
+    for(int c=0; c<3; ++c)
+      r.pos[i][c] = fromHalf(v.pos[i][c]);
+    r.boneId [i] = v.boneId[i];
+    r.weights[i] = float(v.weights[i])/255.f;
+    }
+  return r;
+  }
+
+uint16_t VertexCodec::toHalf(float v) {
+  uint32_t x = 0;
+  std::memcpy(&x,&v,sizeof(x));
+
+  const uint32_t sign = (x>>16) & 0x8000;
+  const uint32_t fexp = (x>>23) & 0xff;
+  uint32_t       mant = x & 0x7fffff;
+  if(fexp==0xff)
+    return uint16_t(sign | 0x7c00 | (mant!=0 ? 0x200 : 0));
+
+  const int32_t exp = int32_t(fexp) - 127 + 15;
+  if(exp<=0) {
+    // denormal half
+    if(exp<-10)
+      return uint16_t(sign);
+    mant |= 0x800000;
+    const uint32_t shift = uint32_t(14-exp);
+    const uint32_t rem   = mant & ((1u<<shift)-1);
+    const uint32_t mid   = 1u<<(shift-1);
+    uint32_t       h     = mant>>shift;
+    if(rem>mid || (rem==mid && (h&1)))
+      h++;
+    return uint16_t(sign | h);
+    }
+
+  uint32_t h = (uint32_t(exp)<<10) | (mant>>13);
+  const uint32_t rem = mant & 0x1fff;
+  if(rem>0x1000 || (rem==0x1000 && (h&1)))
+    h++;
+  if(h>=0x7c00)
+    h = 0x7bff; // clamp to max finite value
+  return uint16_t(sign | h);
+  }
+
+float VertexCodec::fromHalf(uint16_t h) {
+  const uint32_t exp  = (h>>10) & 0x1f;
+  const uint32_t mant = h & 0x3ff;
+  float r = 0;
+  if(exp==0)
+    r = std::ldexp(float(mant),-24);
+  else if(exp==31)
+    r = mant!=0 ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+  else
+    r = std::ldexp(float(mant | 0x400),int(exp)-25);
+  return (h & 0x8000) ? -r : r;
+  }
+
+uint32_t VertexCodec::encodeOct(const float n[3]) {
+  const float l1 = std::abs(n[0])+std::abs(n[1])+std::abs(n[2]);
+  if(l1<=0.f)
+    return 0;
+
+  float x = n[0]/l1;
+  float y = n[1]/l1;
+  if(n[2]<0.f) {
+    const float ox = x;
+    x = (1.f-std::abs(y )) * (ox>=0.f ? 1.f : -1.f);
+    y = (1.f-std::abs(ox)) * (y >=0.f ? 1.f : -1.f);
+    }
+  const auto qx = int16_t(std::lround(std::min(std::max(x,-1.f),1.f)*32767.f));
+  const auto qy = int16_t(std::lround(std::min(std::max(y,-1.f),1.f)*32767.f));
+  return uint32_t(uint16_t(qx)) | (uint32_t(uint16_t(qy))<<16);
+  }
+
+void VertexCodec::decodeOct(uint32_t v, float n[3]) {
+  const auto qx = int16_t(uint16_t(v & 0xffff));
+  const auto qy = int16_t(uint16_t(v >> 16));
+  float x = std::max(float(qx)/32767.f,-1.f);
+  float y = std::max(float(qy)/32767.f,-1.f);
+  float z = 1.f-std::abs(x)-std::abs(y);
+  if(z<0.f) {
+    const float ox = x;
+    x = (1.f-std::abs(y )) * (ox>=0.f ? 1.f : -1.f);
+    y = (1.f-std::abs(ox)) * (y >=0.f ? 1.f : -1.f);
+    }
+  const float l = std::sqrt(x*x+y*y+z*z);
+  n[0] = x/l;
+  n[1] = y/l;
+  n[2] = z/l;
+  }
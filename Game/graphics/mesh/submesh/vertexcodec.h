@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+#include "resources.h"
+
+// Compact encoding of skinned vertices(Resources::VertexA): half-float bone-space positions and uv,
+// octahedral normal in snorm16x2 and unorm8 weights. Decoded in main.vert, under SKINING.
+class VertexCodec final {
+  public:
+    // memory layout of ZenLoad::SkeletalVertex
+    struct Skinned final {
+      float    norm[3];
+      float    uv[2];
+      uint32_t color;
+      float    pos[4][3];
+      uint8_t  boneId[4];
+      float    weights[4];
+      };
+
+    static Resources::VertexA pack  (const Skinned& v);
+    static Skinned            unpack(const Resources::VertexA& v);
+
+    static uint16_t           toHalf   (float v);
+    static float              fromHalf (uint16_t h);
+    static uint32_t           encodeOct(const float n[3]);
+    static void               decodeOct(uint32_t v, float n[3]);
+  };
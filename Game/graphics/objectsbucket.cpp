@@ -2,11 +2,16 @@
 
 #include <Tempest/Log>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include "graphics/dynamic/painter3d.h"
 #include "graphics/mesh/pose.h"
 #include "graphics/mesh/skeleton.h"
 #include "sceneglobals.h"
 
+#include "utils/frameprofiler.h"
 #include "utils/workers.h"
 #include "rendererstorage.h"
 
@@ -91,11 +96,11 @@ ObjectsBucket::ObjectsBucket(const Material& mat, const SceneGlobals& scene, Sto
       break;
     case Material::AdditiveLight: {
       if(shaderType==Animated) {
-        pMain   = &scene.storage.pAnimMAdd;
+        pMain   = &scene.storage.permutation(RendererStorage::AnimMAdd);
         pLight  = nullptr;
         pShadow = nullptr;
         } else {
-        pMain   = &scene.storage.pObjectMAdd;
+        pMain   = &scene.storage.permutation(RendererStorage::ObjectMAdd);
         pLight  = nullptr;
         pShadow = nullptr;
         }
@@ -118,8 +123,8 @@ ObjectsBucket::ObjectsBucket(const Material& mat, const SceneGlobals& scene, Sto
       break;
     case Material::Water:{
       if(shaderType==Animated)
-        pMain = &scene.storage.pAnimWater; else
-        pMain = &scene.storage.pObjectWater;
+        pMain = &scene.storage.permutation(RendererStorage::AnimWater); else
+        pMain = &scene.storage.permutation(RendererStorage::ObjectWater);
       }
       break;
     case Material::InvalidAlpha:
@@ -133,6 +138,8 @@ ObjectsBucket::ObjectsBucket(const Material& mat, const SceneGlobals& scene, Sto
     useSharedUbo = false;
 
   textureInShadowPass = (pShadow==&scene.storage.pObjectAtSh || pShadow==&scene.storage.pAnimAtSh);
+  // no per-object lights and textures: objects can be merged
+  useBatching         = (shaderType==Static && useSharedUbo && pGbuffer!=nullptr);
 
   for(auto& i:uboMat) {
     UboMaterial zero;
@@ -165,12 +172,18 @@ ObjectsBucket::Object& ObjectsBucket::implAlloc(const VboType type, const Bounds
     }
 
   ++valSz;
-  v->vboType   = type;
-  v->vbo       = nullptr;
-  v->vboA      = nullptr;
-  v->ibo       = nullptr;
-  v->bounds    = bounds;
-  v->timeShift = uint64_t(0-scene.tickCount);
+  v->vboType    = type;
+  v->vbo        = nullptr;
+  v->vboA       = nullptr;
+  v->ibo        = nullptr;
+  v->cluster    = nullptr;
+  v->clusterCnt = 0;
+  v->mesh       = nullptr;
+  v->meshSub    = 0;
+  v->batch      = size_t(-1);
+  v->noBatch    = false;
+  v->bounds     = bounds;
+  v->timeShift  = uint64_t(0-scene.tickCount);
 
   if(!useSharedUbo) {
     v->ubo.invalidate();
@@ -236,6 +249,10 @@ void ObjectsBucket::invalidateUbo() {
   }
 
 void ObjectsBucket::preFrameUpdate(uint8_t fId) {
+  if(batchDirty)
+    mkBatches();
+  bakeBatches(fId);
+
   UboMaterial ubo;
   if(mat.texAniMapDirPeriod.x!=0)
     ubo.texAniMapDir.x = float(scene.tickCount%std::abs(mat.texAniMapDirPeriod.x))/float(mat.texAniMapDirPeriod.x);
@@ -250,7 +267,7 @@ void ObjectsBucket::preFrameUpdate(uint8_t fId) {
     }
   }
 
-bool ObjectsBucket::groupVisibility(Painter3d& p) {
+bool ObjectsBucket::groupVisibility(const Painter3d& p) {
   if(shaderType!=Static)
     return true;
 
@@ -279,46 +296,122 @@ bool ObjectsBucket::groupVisibility(Painter3d& p) {
   return p.isVisible(allBounds);
   }
 
-void ObjectsBucket::visibilityPass(Painter3d& p) {
-  indexSz = 0;
-  if(!groupVisibility(p))
+void ObjectsBucket::visibilityPass(const Painter3d* view[V_Count]) {
+  implVisibility(*view[V_Main],V_Main);
+
+  const bool solid = (mat.alpha==Material::Solid || mat.alpha==Material::AlphaTest);
+  if(pShadow!=nullptr && solid) {
+    // near cascade is covered by far one
+    implVisibility   (*view[V_Shadow1],V_Shadow1);
+    implVisibilityAnd(*view[V_Shadow0],V_Shadow0,V_Shadow1);
+    } else {
+    indexSz[V_Shadow1] = 0;
+    indexSz[V_Shadow0] = 0;
+    }
+  }
+
+void ObjectsBucket::implVisibility(const Painter3d& p, View vId) {
+  indexSz[vId] = 0;
+  if(!groupVisibility(p)) {
+    batchVisibility(vId);
     return;
+    }
 
-  Object** idx = index;
+  Object** idx = index[vId];
+  size_t   sz  = 0;
   for(size_t i=0; i<valLast; ++i) {
     auto& v = val[i];
     if(!v.isValid())
       continue;
     if(!p.isVisible(v.bounds) && v.vboType!=VboType::VboMorph)
       continue;
-    idx[indexSz] = &v;
-    ++indexSz;
+    if(v.cluster!=nullptr && !clusterVisibility(v,p,false,vId))
+      continue;
+    idx[sz] = &v;
+    ++sz;
     }
+  indexSz[vId] = sz;
+  batchVisibility(vId);
   }
 
-void ObjectsBucket::visibilityPassAnd(Painter3d& p) {
+void ObjectsBucket::implVisibilityAnd(const Painter3d& p, View vId, View src) {
   size_t nextSz = 0;
-  for(size_t i=0; i<indexSz; ++i) {
-    auto& v = *index[i];
+  for(size_t i=0; i<indexSz[src]; ++i) {
+    auto& v = *index[src][i];
     if(!p.isVisible(v.bounds))
       continue;
-    index[nextSz] = &v;
+    if(v.cluster!=nullptr && !clusterVisibility(v,p,true,vId))
+      continue;
+    index[vId][nextSz] = &v;
     ++nextSz;
     }
-  indexSz = nextSz;
+  indexSz[vId] = nextSz;
+  batchVisibility(vId);
+  }
+
+bool ObjectsBucket::clusterVisibility(Object& v, const Painter3d& p, bool intersect, View vId) {
+  // backface culling by normal cone is valid only for single-sided materials
+  const bool backface = (mat.alpha==Material::Solid);
+  auto&      range    = v.range[vId];
+  range.clear();
+  for(size_t i=0; i<v.clusterCnt; ++i) {
+    auto& c   = v.cluster[i];
+    bool  vis = (!intersect || v.clusterVis[i]!=0) && p.isVisible(c,backface);
+    v.clusterVis[i] = vis ? 1 : 0;
+    if(!vis)
+      continue;
+    if(!range.empty()) {
+      auto& r = range.back();
+      if(c.firstIndex-(r.first+r.count)<=CLUSTER_GAP) {
+        r.count = c.firstIndex+c.indexCount-r.first;
+        continue;
+        }
+      }
+    DrawRange r;
+    r.first = c.firstIndex;
+    r.count = c.indexCount;
+    range.push_back(r);
+    }
+  return !range.empty();
   }
 
 size_t ObjectsBucket::alloc(const Tempest::VertexBuffer<Vertex>&  vbo,
                             const Tempest::IndexBuffer<uint32_t>& ibo,
-                            const Bounds& bounds) {
+                            const Bounds& bounds,
+                            const PackedMesh::Cluster* cluster, size_t clusterCnt) {
   Object* v = &implAlloc(VboType::VboVertex,bounds);
-  v->vbo = &vbo;
-  v->ibo = &ibo;
+  v->vbo        = &vbo;
+  v->ibo        = &ibo;
+  v->cluster    = clusterCnt>0 ? cluster : nullptr;
+  v->clusterCnt = clusterCnt;
+  v->clusterVis.assign(clusterCnt,0);
   polySz+=ibo.size();
   polyAvg = polySz/valSz;
   return std::distance(val,v);
   }
 
+size_t ObjectsBucket::alloc(const Tempest::VertexBuffer<Vertex>&  vbo,
+                            const Tempest::IndexBuffer<uint32_t>& ibo,
+                            const StaticMesh& mesh, size_t subId,
+                            const Bounds& bounds) {
+  const size_t id = alloc(vbo,ibo,bounds);
+  if(useBatching) {
+    auto& v = val[id];
+    v.mesh     = &mesh;
+    v.meshSub  = subId;
+    batchDirty = true;
+
+    // cpu copy is loaded here, on streaming path, once mesh is repeated enough; preFrameUpdate does no file io
+    size_t cnt = 0;
+    for(size_t i=0; i<valLast; ++i)
+      if(val[i].mesh==&mesh && val[i].meshSub==subId)
+        ++cnt;
+    if(cnt>=BATCH_MIN)
+      mesh.loadCpuCopy();
+    }
+  return id;
+  }
+
 size_t ObjectsBucket::alloc(const Tempest::VertexBuffer<VertexA>& vbo,
                             const Tempest::IndexBuffer<uint32_t>& ibo,
                             const Bounds& bounds) {
@@ -344,12 +437,18 @@ void ObjectsBucket::free(const size_t objId) {
     storage.ani.free(v.storageAni);
   if(v.ibo!=nullptr)
     polySz -= v.ibo->size();
+  if(v.batch!=size_t(-1))
+    removeFromBatch(v);
   v.vboType = VboType::NoVbo;
   v.vbo     = nullptr;
   for(size_t i=0;i<Resources::MaxFramesInFlight;++i)
     v.vboM[i] = nullptr;
   v.vboA    = nullptr;
   v.ibo     = nullptr;
+  v.cluster    = nullptr;
+  v.clusterCnt = 0;
+  v.mesh       = nullptr;
+  v.meshSub    = 0;
   valSz--;
   valLast = 0;
   for(size_t i=CAPACITY; i>0;) {
@@ -365,16 +464,22 @@ void ObjectsBucket::free(const size_t objId) {
   }
 
 void ObjectsBucket::draw(Tempest::Encoder<Tempest::CommandBuffer>& p, uint8_t fId) {
-  if(pMain==nullptr || indexSz==0)
+  const size_t visSz = indexSz[V_Main];
+  if(pMain==nullptr || visSz==0)
     return;
 
-  if(useSharedUbo)
+  size_t draws = 0;
+  if(useSharedUbo) {
     p.setUniforms(*pMain,uboShared.ubo[fId]);
+    draws += drawBatches(p,*pMain,fId,V_Main);
+    }
 
   UboPush pushBlock;
-  Object** idx = index;
-  for(size_t i=0;i<indexSz;++i) {
+  Object** idx = index[V_Main];
+  for(size_t i=0;i<visSz;++i) {
     auto& v = *idx[i];
+    if(v.batch!=size_t(-1))
+      continue;
 
     pushBlock.pos = v.pos;
     const size_t cnt = v.lightCnt;
@@ -396,33 +501,29 @@ void ObjectsBucket::draw(Tempest::Encoder<Tempest::CommandBuffer>& p, uint8_t fI
       p.setUniforms(*pMain,ubo);
       }
 
-    switch(v.vboType) {
-      case VboType::NoVbo:
-        break;
-      case VboType::VboVertex:
-        p.draw(*v.vbo, *v.ibo);
-        break;
-      case VboType::VboVertexA:
-        p.draw(*v.vboA,*v.ibo);
-        break;
-      case VboType::VboMorph:
-        p.draw(*v.vboM[fId]);
-        break;
-      }
+    draws += drawObject(p,v,fId,V_Main);
     }
+  FrameProfiler::count(FrameProfiler::DrawCalls,  draws);
+  FrameProfiler::count(FrameProfiler::DrawObjects,visSz);
   }
 
 void ObjectsBucket::drawGBuffer(Tempest::Encoder<CommandBuffer>& p, uint8_t fId) {
-  if(pGbuffer==nullptr || indexSz==0)
+  const size_t visSz = indexSz[V_Main];
+  if(pGbuffer==nullptr || visSz==0)
     return;
 
-  if(useSharedUbo)
+  size_t draws = 0;
+  if(useSharedUbo) {
     p.setUniforms(*pGbuffer,uboShared.ubo[fId]);
+    draws += drawBatches(p,*pGbuffer,fId,V_Main);
+    }
 
   UboPush pushBlock;
-  Object** idx = index;
-  for(size_t i=0;i<indexSz;++i) {
+  Object** idx = index[V_Main];
+  for(size_t i=0;i<visSz;++i) {
     auto& v = *idx[i];
+    if(v.batch!=size_t(-1))
+      continue;
 
     pushBlock.pos = v.pos;
     const size_t cnt = v.lightCnt;
@@ -444,20 +545,10 @@ void ObjectsBucket::drawGBuffer(Tempest::Encoder<CommandBuffer>& p, uint8_t fId)
       p.setUniforms(*pGbuffer,ubo);
       }
 
-    switch(v.vboType) {
-      case VboType::NoVbo:
-        break;
-      case VboType::VboVertex:
-        p.draw(*v.vbo, *v.ibo);
-        break;
-      case VboType::VboVertexA:
-        p.draw(*v.vboA,*v.ibo);
-        break;
-      case VboType::VboMorph:
-        p.draw(*v.vboM[fId]);
-        break;
-      }
+    draws += drawObject(p,v,fId,V_Main);
     }
+  FrameProfiler::count(FrameProfiler::DrawCalls,  draws);
+  FrameProfiler::count(FrameProfiler::DrawObjects,visSz);
   }
 
 void ObjectsBucket::drawLight(Tempest::Encoder<Tempest::CommandBuffer>& p, uint8_t fId) {
@@ -465,15 +556,17 @@ void ObjectsBucket::drawLight(Tempest::Encoder<Tempest::CommandBuffer>& p, uint8
   if(disabled)
     return;
 
-  if(pLight==nullptr || indexSz==0)
+  const size_t visSz = indexSz[V_Main];
+  if(pLight==nullptr || visSz==0)
     return;
 
   if(useSharedUbo)
     p.setUniforms(*pLight,uboShared.ubo[fId]);
 
+  size_t draws = 0;
   UboPush pushBlock;
-  Object** idx = index;
-  for(size_t i=0;i<indexSz;++i) {
+  Object** idx = index[V_Main];
+  for(size_t i=0;i<visSz;++i) {
     auto& v = *idx[i];
     if(v.lightCnt<=LIGHT_BLOCK)
       continue;
@@ -494,34 +587,30 @@ void ObjectsBucket::drawLight(Tempest::Encoder<Tempest::CommandBuffer>& p, uint8
         pushBlock.light[r].range = 0;
         }
       p.setUniforms(*pLight,&pushBlock,sizeof(pushBlock));
-      switch(v.vboType) {
-        case VboType::NoVbo:
-          break;
-        case VboType::VboVertex:
-          p.draw(*v.vbo, *v.ibo);
-          break;
-        case VboType::VboVertexA:
-          p.draw(*v.vboA,*v.ibo);
-          break;
-        case VboType::VboMorph:
-          p.draw(*v.vboM[fId]);
-          break;
-        }
+      draws += drawObject(p,v,fId,V_Main);
       }
     }
+  FrameProfiler::count(FrameProfiler::DrawCalls,draws);
   }
 
 void ObjectsBucket::drawShadow(Tempest::Encoder<Tempest::CommandBuffer>& p, uint8_t fId, int layer) {
-  if(pShadow==nullptr || indexSz==0)
+  const View   vId   = View(layer);
+  const size_t visSz = indexSz[vId];
+  if(pShadow==nullptr || visSz==0)
     return;
 
+  size_t  draws     = 0;
   UboPush pushBlock = {};
-  if(useSharedUbo)
+  if(useSharedUbo) {
     p.setUniforms(*pShadow,uboShared.uboSh[fId][layer]);
+    draws += drawBatches(p,*pShadow,fId,vId);
+    }
 
-  Object** idx = index;
-  for(size_t i=0;i<indexSz;++i) {
+  Object** idx = index[vId];
+  for(size_t i=0;i<visSz;++i) {
     auto& v = *idx[i];
+    if(v.batch!=size_t(-1))
+      continue;
 
     if(!useSharedUbo) {
       auto& ubo = v.ubo.uboSh[fId][layer];
@@ -534,22 +623,235 @@ void ObjectsBucket::drawShadow(Tempest::Encoder<Tempest::CommandBuffer>& p, uint
 
     pushBlock.pos = v.pos;
     p.setUniforms(*pShadow,&pushBlock,sizeof(pushBlock));
-    switch(v.vboType) {
-      case VboType::NoVbo:
-        break;
-      case VboType::VboVertex:
-        p.draw(*v.vbo, *v.ibo);
-        break;
-      case VboType::VboVertexA:
-        p.draw(*v.vboA,*v.ibo);
-        break;
-      case VboType::VboMorph:
-        p.draw(*v.vboM[fId]);
+    draws += drawObject(p,v,fId,vId);
+    }
+  FrameProfiler::count(FrameProfiler::DrawCalls,  draws);
+  FrameProfiler::count(FrameProfiler::DrawObjects,visSz);
+  }
+
+size_t ObjectsBucket::drawIndexed(Tempest::Encoder<Tempest::CommandBuffer>& p, const Object& v, View vId) {
+  if(v.cluster==nullptr) {
+    p.draw(*v.vbo, *v.ibo);
+    return 1;
+    }
+  for(auto& r:v.range[vId])
+    p.draw(*v.vbo, *v.ibo, r.first, r.count);
+  return v.range[vId].size();
+  }
+
+size_t ObjectsBucket::drawObject(Tempest::Encoder<Tempest::CommandBuffer>& p, const Object& v, uint8_t fId, View vId) {
+  switch(v.vboType) {
+    case VboType::NoVbo:
+      return 0;
+    case VboType::VboVertex:
+      return drawIndexed(p,v,vId);
+    case VboType::VboVertexA:
+      p.draw(*v.vboA,*v.ibo);
+      return 1;
+    case VboType::VboMorph:
+      p.draw(*v.vboM[fId]);
+      return 1;
+    }
+  return 0;
+  }
+
+bool ObjectsBucket::isBatchable(const Object& v) const {
+  return v.vboType==VboType::VboVertex && v.mesh!=nullptr && !v.noBatch;
+  }
+
+void ObjectsBucket::mkBatches() {
+  // only objects, that are not batched yet, are grouped; existing batches stay as is
+  batchDirty = false;
+  for(size_t i=0; i<valLast; ++i) {
+    auto& v = val[i];
+    if(v.batch!=size_t(-1) || !isBatchable(v))
+      continue;
+
+    size_t id = size_t(-1);
+    for(size_t r=0; r<batches.size(); ++r)
+      if(batches[r].mesh==v.mesh && batches[r].meshSub==v.meshSub && !batches[r].inst.empty()) {
+        id = r;
         break;
+        }
+
+    if(id==size_t(-1)) {
+      size_t cnt = 0;
+      for(size_t r=i; r<valLast; ++r) {
+        auto& x = val[r];
+        if(x.mesh==v.mesh && x.meshSub==v.meshSub && x.batch==size_t(-1) && isBatchable(x))
+          ++cnt;
+        }
+      if(cnt<BATCH_MIN)
+        continue;
+
+      auto cpu = v.mesh->cpuCopy();
+      if(cpu==nullptr)
+        continue;
+      if(v.meshSub>=cpu->ibo.size()) {
+        v.noBatch = true;
+        continue;
+        }
+
+      for(size_t r=0; r<batches.size(); ++r)
+        if(batches[r].inst.empty()) {
+          id = r;
+          break;
+          }
+      if(id==size_t(-1)) {
+        id = batches.size();
+        batches.emplace_back();
+        }
+      auto& b = batches[id];
+      b.mesh    = v.mesh;
+      b.meshSub = v.meshSub;
+      b.cpu     = cpu;
       }
+    addToBatch(id,v);
     }
   }
 
+void ObjectsBucket::addToBatch(size_t id, Object& v) {
+  auto& b = batches[id];
+  v.batch     = id;
+  v.batchSlot = uint32_t(b.inst.size());
+  b.inst.push_back(&v);
+  b.vis.push_back(0);
+  b.version++;
+  }
+
+void ObjectsBucket::removeFromBatch(Object& v) {
+  // last instance takes the slot: only this batch has to be baked again
+  auto& b    = batches[v.batch];
+  auto  last = b.inst.back();
+  b.inst[v.batchSlot] = last;
+  last->batchSlot     = v.batchSlot;
+  b.inst.pop_back();
+  b.vis.pop_back();
+  b.version++;
+  v.batch = size_t(-1);
+  }
+
+void ObjectsBucket::bakeBatches(uint8_t fId) {
+  // buffers of this frame are not in use by gpu anymore
+  for(auto& b:batches) {
+    if(b.baked[fId]==b.version)
+      continue;
+    b.baked[fId] = b.version;
+    if(b.inst.empty()) {
+      b.vbo[fId] = Tempest::VertexBuffer<Vertex>();
+      b.ibo[fId] = Tempest::IndexBuffer<uint32_t>();
+      continue;
+      }
+    bake(b,fId);
+    }
+  }
+
+static Vec3 mapDir(const Matrix4x4& m, const Vec3& origin, float x, float y, float z) {
+  m.project(x,y,z);
+  return Vec3(x-origin.x,y-origin.y,z-origin.z);
+  }
+
+void ObjectsBucket::bake(Batch& b, uint8_t fId) {
+  auto& src = b.cpu->vbo;
+  auto& ind = b.cpu->ibo[b.meshSub];
+  bakeVbo.resize(src.size()*b.inst.size());
+  bakeIbo.resize(ind.size()*b.inst.size());
+
+  Vertex*   pv = bakeVbo.data();
+  uint32_t* pi = bakeIbo.data();
+  for(auto obj:b.inst) {
+    auto&          m    = obj->pos;
+    const uint32_t base = uint32_t(pv-bakeVbo.data());
+
+    // normals are transformed by inverse-transpose of model matrix: columns of cofactor matrix
+    Vec3 o;
+    m.project(o.x,o.y,o.z);
+    const Vec3  ax = mapDir(m,o,1,0,0), ay = mapDir(m,o,0,1,0), az = mapDir(m,o,0,0,1);
+    const Vec3  nx = Vec3::crossProduct(ay,az);
+    const Vec3  ny = Vec3::crossProduct(az,ax);
+    const Vec3  nz = Vec3::crossProduct(ax,ay);
+    const float det = ax.x*nx.x + ax.y*nx.y + ax.z*nx.z;
+    const float sgn = det<0.f ? -1.f : 1.f;
+
+    for(auto& s:src) {
+      *pv = s;
+      m.project(pv->pos[0],pv->pos[1],pv->pos[2]);
+
+      const float x = (nx.x*s.norm[0] + ny.x*s.norm[1] + nz.x*s.norm[2])*sgn;
+      const float y = (nx.y*s.norm[0] + ny.y*s.norm[1] + nz.y*s.norm[2])*sgn;
+      const float z = (nx.z*s.norm[0] + ny.z*s.norm[1] + nz.z*s.norm[2])*sgn;
+      const float l = std::sqrt(x*x+y*y+z*z);
+      if(l>0.f) {
+        pv->norm[0] = x/l;
+        pv->norm[1] = y/l;
+        pv->norm[2] = z/l;
+        }
+      ++pv;
+      }
+    for(auto id:ind) {
+      *pi = base+id;
+      ++pi;
+      }
+    }
+  b.vbo[fId] = Resources::vbo<Vertex>(bakeVbo.data(),bakeVbo.size());
+  b.ibo[fId] = Resources::ibo(bakeIbo.data(),bakeIbo.size());
+  }
+
+void ObjectsBucket::batchVisibility(View vId) {
+  if(batches.empty())
+    return;
+  for(auto& b:batches)
+    std::fill(b.vis.begin(),b.vis.end(),uint8_t(0));
+  for(size_t i=0; i<indexSz[vId]; ++i) {
+    auto& v = *index[vId][i];
+    if(v.batch<batches.size())
+      batches[v.batch].vis[v.batchSlot] = 1;
+    }
+
+  for(auto& b:batches) {
+    auto& range = b.range[vId];
+    range.clear();
+    if(b.inst.empty())
+      continue;
+    const uint32_t cnt = uint32_t(b.cpu->ibo[b.meshSub].size());
+    for(size_t i=0; i<b.vis.size(); ++i) {
+      if(b.vis[i]==0)
+        continue;
+      const uint32_t first = uint32_t(i)*cnt;
+      if(!range.empty()) {
+        auto& r = range.back();
+        if(first-(r.first+r.count)<=CLUSTER_GAP) {
+          r.count = first+cnt-r.first;
+          continue;
+          }
+        }
+      DrawRange r;
+      r.first = first;
+      r.count = cnt;
+      range.push_back(r);
+      }
+    }
+  }
+
+size_t ObjectsBucket::drawBatches(Tempest::Encoder<Tempest::CommandBuffer>& p, const Tempest::RenderPipeline& pipeline, uint8_t fId, View vId) {
+  if(batches.empty())
+    return 0;
+
+  UboPush pushBlock = {};
+  pushBlock.pos.identity();
+  p.setUniforms(pipeline,&pushBlock,sizeof(pushBlock));
+
+  size_t draws = 0;
+  for(auto& b:batches) {
+    if(b.inst.empty() || b.baked[fId]!=b.version)
+      continue;
+    for(auto& r:b.range[vId])
+      p.draw(b.vbo[fId], b.ibo[fId], r.first, r.count);
+    draws += b.range[vId].size();
+    }
+  return draws;
+  }
+
 void ObjectsBucket::draw(size_t id, Tempest::Encoder<Tempest::CommandBuffer>& p, uint8_t fId) {
   auto& v = val[id];
   if(v.vbo==nullptr || pMain==nullptr)
@@ -575,6 +877,11 @@ void ObjectsBucket::draw(size_t id, Tempest::Encoder<Tempest::CommandBuffer>& p,
 
 void ObjectsBucket::setObjMatrix(size_t i, const Matrix4x4& m) {
   auto& v = val[i];
+  if(v.batch!=size_t(-1) && std::memcmp(&v.pos,&m,sizeof(m))!=0) {
+    // object is moving: not worth to bake it again
+    v.noBatch = true;
+    removeFromBatch(v);
+    }
   v.bounds.setObjMatrix(m);
   v.pos = m;
 
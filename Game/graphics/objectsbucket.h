@@ -6,6 +6,8 @@
 #include <Tempest/UniformBuffer>
 #include <Tempest/UniformsLayout>
 
+#include "graphics/mesh/submesh/packedmesh.h"
+#include "graphics/mesh/submesh/staticmesh.h"
 #include "bounds.h"
 #include "material.h"
 #include "resources.h"
@@ -26,6 +28,8 @@ class ObjectsBucket final {
     enum {
       LIGHT_BLOCK  = 2,
       MAX_LIGHT    = 64,
+      CLUSTER_GAP  = 128*3, // hidden indices between visible clusters, drawn anyway to save a draw call
+      BATCH_MIN    = 4,     // identical static meshes in bucket, to be merged into one batch
       };
 
   public:
@@ -33,6 +37,14 @@ class ObjectsBucket final {
       CAPACITY     = 128,
       };
 
+    // culling results are kept per view, to cull all views of a frame in one parallel pass
+    enum View : uint8_t {
+      V_Shadow0 = 0,
+      V_Shadow1 = 1,
+      V_Main    = 2,
+      V_Count,
+      };
+
     enum Type : uint8_t {
       Static,
       Movable,
@@ -98,6 +110,11 @@ class ObjectsBucket final {
 
     size_t                    alloc(const Tempest::VertexBuffer<Vertex>  &vbo,
                                     const Tempest::IndexBuffer<uint32_t> &ibo,
+                                    const Bounds& bounds,
+                                    const PackedMesh::Cluster* cluster = nullptr, size_t clusterCnt = 0);
+    size_t                    alloc(const Tempest::VertexBuffer<Vertex>  &vbo,
+                                    const Tempest::IndexBuffer<uint32_t> &ibo,
+                                    const StaticMesh& mesh, size_t subId,
                                     const Bounds& bounds);
     size_t                    alloc(const Tempest::VertexBuffer<VertexA> &vbo,
                                     const Tempest::IndexBuffer<uint32_t> &ibo,
@@ -110,8 +127,7 @@ class ObjectsBucket final {
     void                      invalidateUbo();
 
     void                      preFrameUpdate(uint8_t fId);
-    void                      visibilityPass(Painter3d& p);
-    void                      visibilityPassAnd(Painter3d& p);
+    void                      visibilityPass(const Painter3d* view[V_Count]);
     void                      draw       (Tempest::Encoder<Tempest::CommandBuffer>& painter, uint8_t fId);
     void                      drawGBuffer(Tempest::Encoder<Tempest::CommandBuffer>& painter, uint8_t fId);
     void                      drawLight  (Tempest::Encoder<Tempest::CommandBuffer>& painter, uint8_t fId);
@@ -126,6 +142,11 @@ class ObjectsBucket final {
       float         range=0;
       };
 
+    struct DrawRange final {
+      uint32_t first = 0;
+      uint32_t count = 0;
+      };
+
     struct UboPush final {
       Tempest::Matrix4x4 pos;
       ShLight            light[LIGHT_BLOCK];
@@ -169,16 +190,44 @@ class ObjectsBucket final {
       size_t                                texAnim=0;
       uint64_t                              timeShift=0;
 
+      const PackedMesh::Cluster*            cluster    = nullptr;
+      size_t                                clusterCnt = 0;
+      std::vector<uint8_t>                  clusterVis;
+      std::vector<DrawRange>                range[V_Count];
+
+      const StaticMesh*                     mesh      = nullptr; // source of batch geometry
+      size_t                                meshSub   = 0;
+      size_t                                batch     = size_t(-1);
+      uint32_t                              batchSlot = 0;
+      bool                                  noBatch   = false; // moved after placement
+
       bool                                  isValid() const { return vboType!=VboType::NoVbo; }
       };
 
+    // Static objects with the same mesh, baked into world-space vertex buffer(one per frame in flight).
+    // Each instance owns index range [slot*count, (slot+1)*count); visible ranges are drawn with identity matrix.
+    // Batch is baked again only after own instances have changed; empty batch is reused for next mesh.
+    struct Batch final {
+      const StaticMesh*                     mesh    = nullptr;
+      size_t                                meshSub = 0;
+      const StaticMesh::CpuCopy*            cpu     = nullptr;
+      std::vector<Object*>                  inst;
+      std::vector<uint8_t>                  vis;
+      std::vector<DrawRange>                range[V_Count];
+
+      uint64_t                              version = 0;
+      uint64_t                              baked[Resources::MaxFramesInFlight] = {};
+      Tempest::VertexBuffer<Vertex>         vbo  [Resources::MaxFramesInFlight];
+      Tempest::IndexBuffer<uint32_t>        ibo  [Resources::MaxFramesInFlight];
+      };
+
     Descriptors               uboShared;
 
     Object                    val  [CAPACITY];
     size_t                    valSz=0;
     size_t                    valLast=0;
-    Object*                   index[CAPACITY] = {};
-    size_t                    indexSz=0;
+    Object*                   index[V_Count][CAPACITY] = {};
+    size_t                    indexSz[V_Count] = {};
     size_t                    polySz=0;
     size_t                    polyAvg=0;
 
@@ -188,9 +237,15 @@ class ObjectsBucket final {
 
     Tempest::UniformBuffer<UboMaterial> uboMat[Resources::MaxFramesInFlight];
 
+    std::vector<Batch>        batches;
+    bool                      batchDirty = false; // new batchable objects, to be grouped
+    std::vector<Vertex>       bakeVbo;
+    std::vector<uint32_t>     bakeIbo;
+
     const Type                shaderType;
     bool                      useSharedUbo=false;
     bool                      textureInShadowPass=false;
+    bool                      useBatching=false;
 
     Bounds                    allBounds;
 
@@ -201,7 +256,21 @@ class ObjectsBucket final {
 
     Object& implAlloc(const VboType type, const Bounds& bounds);
     void    uboSetCommon(Descriptors& v);
-    bool    groupVisibility(Painter3d& p);
+    bool    groupVisibility(const Painter3d& p);
+    void    implVisibility   (const Painter3d& p, View vId);
+    void    implVisibilityAnd(const Painter3d& p, View vId, View src);
+    bool    clusterVisibility(Object& v, const Painter3d& p, bool intersect, View vId);
+    size_t  drawIndexed(Tempest::Encoder<Tempest::CommandBuffer>& p, const Object& v, View vId);
+    size_t  drawObject (Tempest::Encoder<Tempest::CommandBuffer>& p, const Object& v, uint8_t fId, View vId);
+
+    bool    isBatchable(const Object& v) const;
+    void    mkBatches();
+    void    addToBatch(size_t id, Object& v);
+    void    removeFromBatch(Object& v);
+    void    bakeBatches(uint8_t fId);
+    void    bake(Batch& b, uint8_t fId);
+    void    batchVisibility(View vId);
+    size_t  drawBatches(Tempest::Encoder<Tempest::CommandBuffer>& p, const Tempest::RenderPipeline& pipeline, uint8_t fId, View vId);
 
     void    setObjMatrix(size_t i,const Tempest::Matrix4x4& m);
     void    setPose     (size_t i,const Pose& sk);
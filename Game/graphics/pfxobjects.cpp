@@ -13,6 +13,7 @@
 #include "particlefx.h"
 #include "lightsource.h"
 #include "rendererstorage.h"
+#include "utils/frameprofiler.h"
 
 using namespace Tempest;
 
@@ -500,6 +501,7 @@ void PfxObjects::resetTicks() {
   }
 
 void PfxObjects::tick(uint64_t ticks) {
+  FrameProfiler::Scope scope("PfxObjects::tick");
   static bool disabled = false;
   if(disabled)
     return;
@@ -564,6 +566,10 @@ void PfxObjects::preFrameUpdate(uint8_t fId) {
     }
   }
 
+void PfxObjects::setSeed(uint32_t s) {
+  rndEngine.seed(s);
+  }
+
 float PfxObjects::randf() {
   return float(rndEngine()%10000)/10000.f;
   }
@@ -150,6 +150,7 @@ class PfxObjects final {
       Tempest::Vec3 topA  = {0,1,0};
       };
 
+    static void                   setSeed(uint32_t s);
     static float                  randf();
     static float                  randf(float base, float var);
     Bucket&                       getBucket(const ParticleFx& decl);
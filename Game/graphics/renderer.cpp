@@ -5,6 +5,8 @@
 #include <Tempest/Semaphore>
 #include <Tempest/Log>
 
+#include <chrono>
+
 #include "graphics/mesh/submesh/staticmesh.h"
 #include "ui/inventorymenu.h"
 #include "camera.h"
@@ -112,6 +114,7 @@ void Renderer::resetSwapchain() {
   }
 
 void Renderer::onWorldChanged() {
+  firstWorldFrame = true;
   if(auto wview=gothic.worldView()){
     if(zbuffer.w()>0 && zbuffer.h()>0)
       wview->initPipeline(uint32_t(zbuffer.w()),uint32_t(zbuffer.h()));
@@ -143,15 +146,29 @@ void Renderer::draw(Tempest::Encoder<CommandBuffer>& cmd,
     return;
     }
 
+  const auto t0 = std::chrono::steady_clock::now();
   Painter3d painter(cmd);
+  Painter3d painterSh0(cmd), painterSh1(cmd);
   wview->setModelView(view,shadow,2);
   wview->setFrameGlobals(textureCast(shadowMapFinal),gothic.world()->tickCount(),frameId);
   wview->setGbuffer(textureCast(lightingBuf),textureCast(gbufDiffuse),textureCast(gbufNormal),textureCast(gbufDepth));
 
+  Matrix4x4 vinv = view;
+  Vec3      vpos;
+  vinv.inverse();
+  vinv.project(vpos.x,vpos.y,vpos.z);
+
+  // cull main view and shadow cascades at once, before recording
+  const Painter3d* painterSh[2] = {&painterSh0,&painterSh1};
+  painterSh0.setFrustrum(shadow[0]);
+  painterSh1.setFrustrum(shadow[1]);
+  painter.setFrustrum(wview->viewProj(view));
+  painter.setViewPosition(vpos);
+  wview->visibilityPass(painter,painterSh);
+
   for(uint8_t i=2;i>0;) {
     --i;
     cmd.setFramebuffer(fboShadow[i],shadowPass);
-    painter.setFrustrum(shadow[i]);
     wview->drawShadow(cmd,painter,frameId,i);
     }
 
@@ -159,7 +176,6 @@ void Renderer::draw(Tempest::Encoder<CommandBuffer>& cmd,
   cmd.setUniforms(stor.pComposeShadow,uboShadowComp);
   cmd.draw(Resources::fsqVbo());
 
-  painter.setFrustrum(wview->viewProj(view));
   cmd.setFramebuffer(fboGBuf,gbufPass);
   wview->drawGBuffer(cmd,painter,frameId);
 
@@ -170,6 +186,12 @@ void Renderer::draw(Tempest::Encoder<CommandBuffer>& cmd,
   cmd.setFramebuffer(fbo,mainPass);
   wview->drawLights (cmd,painter,frameId);
   wview->drawMain   (cmd,painter,frameId);
+
+  if(firstWorldFrame) {
+    firstWorldFrame = false;
+    const auto t1 = std::chrono::steady_clock::now();
+    Log::i("pipelines: first world frame recorded in ",std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count(),"ms");
+    }
   }
 
 void Renderer::draw(Tempest::Encoder<CommandBuffer>& cmd, FrameBuffer& fbo, InventoryMenu &inventory) {
@@ -60,6 +60,7 @@ class Renderer final {
 
     Tempest::Uniforms                 uboShadowComp, uboCopy;
     RendererStorage                   stor;
+    bool                              firstWorldFrame = false; // first frame records pipelines, compiled on first draw
 
     void draw(Tempest::Encoder<Tempest::CommandBuffer> &cmd, Tempest::FrameBuffer& fbo, Tempest::FrameBuffer& fboCpy, const Gothic& gothic, uint8_t frameId);
     void draw(Tempest::Encoder<Tempest::CommandBuffer> &cmd, Tempest::FrameBuffer& fbo, InventoryMenu& inv);
@@ -1,6 +1,9 @@
 #include "rendererstorage.h"
 
 #include <Tempest/Device>
+#include <Tempest/Log>
+
+#include <chrono>
 
 #include "gothic.h"
 #include "resources.h"
@@ -41,15 +44,16 @@ void RendererStorage::Material::load(Device &device, const char *tag) {
 
 RendererStorage::RendererStorage(Device& device, Gothic& gothic)
   :device(device) {
-  Material obj, objAt, objG, objAtG, objEmi, objShadow, objShadowAt, objWater;
+  // Tempest compiles VkPipeline lazily, on first draw; this is shader modules and pipeline layouts only
+  auto t0 = std::chrono::steady_clock::now();
+
+  Material obj, objAt, objG, objAtG, objShadow, objShadowAt;
   obj        .load(device,"");
   objG       .load(device,"gbuffer");
   objAt      .load(device,"at");
   objAtG     .load(device,"at_gbuffer");
-  objEmi     .load(device,"emi");
   objShadow  .load(device,"shadow");
   objShadowAt.load(device,"shadow_at");
-  objWater   .load(device,"water");
 
   RenderState stateAlpha;
   stateAlpha.setCullFaceMode(RenderState::CullMode::Front);
@@ -74,13 +78,6 @@ RendererStorage::RendererStorage(Device& device, Gothic& gothic)
   stateFsq.setZTestMode   (RenderState::ZTestMode::LEqual);
   stateFsq.setZWriteEnabled(false);
 
-  RenderState stateMAdd;
-  stateMAdd.setCullFaceMode (RenderState::CullMode::Front);
-  stateMAdd.setBlendSource  (RenderState::BlendMode::src_alpha);
-  stateMAdd.setBlendDest    (RenderState::BlendMode::one);
-  stateMAdd.setZTestMode    (RenderState::ZTestMode::Less);
-  stateMAdd.setZWriteEnabled(false);
-
   {
   auto sh = GothicShader::get("copy.vert.sprv");
   auto vs = device.shader(sh.data,sh.len);
@@ -114,12 +111,6 @@ RendererStorage::RendererStorage(Device& device, Gothic& gothic)
   pObjectAlpha   = pipeline<Resources::Vertex> (stateAlpha, obj.obj);
   pAnimAlpha     = pipeline<Resources::VertexA>(stateAlpha, obj.ani);
 
-  pObjectMAdd    = pipeline<Resources::Vertex> (stateMAdd,  objEmi.obj);
-  pAnimMAdd      = pipeline<Resources::VertexA>(stateMAdd,  objEmi.ani);
-
-  pObjectWater   = pipeline<Resources::Vertex> (stateObj,   objWater.obj);
-  pAnimWater     = pipeline<Resources::VertexA>(stateObj,   objWater.ani);
-
   {
   RenderState state;
   state.setCullFaceMode (RenderState::CullMode::Front);
@@ -173,9 +164,56 @@ RendererStorage::RendererStorage(Device& device, Gothic& gothic)
   pObjectAtSh = pipeline<Resources::Vertex> (state,objShadowAt.obj);
   pAnimSh     = pipeline<Resources::VertexA>(state,objShadow  .ani);
   pAnimAtSh   = pipeline<Resources::VertexA>(state,objShadowAt.ani);
+
+  auto t1 = std::chrono::steady_clock::now();
+  Log::i("pipelines: created in ",std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count(),"ms");
+  }
+
+const RenderPipeline& RendererStorage::permutation(Permutation p) const {
+  std::lock_guard<std::mutex> guard(rareSync);
+  if(!rareReady[p]) {
+    auto t0 = std::chrono::steady_clock::now();
+    rare[p]      = implPermutation(p);
+    rareReady[p] = true;
+    auto t1 = std::chrono::steady_clock::now();
+    Log::i("pipelines: permutation ",int(p)," created in ",std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count(),"ms");
+    }
+  return rare[p];
+  }
+
+RenderPipeline RendererStorage::implPermutation(Permutation p) const {
+  RenderState stateObj;
+  stateObj.setCullFaceMode(RenderState::CullMode::Front);
+  stateObj.setZTestMode   (RenderState::ZTestMode::Less);
+
+  RenderState stateMAdd;
+  stateMAdd.setCullFaceMode (RenderState::CullMode::Front);
+  stateMAdd.setBlendSource  (RenderState::BlendMode::src_alpha);
+  stateMAdd.setBlendDest    (RenderState::BlendMode::one);
+  stateMAdd.setZTestMode    (RenderState::ZTestMode::Less);
+  stateMAdd.setZWriteEnabled(false);
+
+  ShaderPair sh;
+  switch(p) {
+    case ObjectWater:
+      sh.load(device,"obj_water");
+      return pipeline<Resources::Vertex> (stateObj, sh);
+    case AnimWater:
+      sh.load(device,"ani_water");
+      return pipeline<Resources::VertexA>(stateObj, sh);
+    case ObjectMAdd:
+      sh.load(device,"obj_emi");
+      return pipeline<Resources::Vertex> (stateMAdd,sh);
+    case AnimMAdd:
+      sh.load(device,"ani_emi");
+      return pipeline<Resources::VertexA>(stateMAdd,sh);
+    case PermutationCount:
+      break;
+    }
+  return RenderPipeline();
   }
 
 template<class Vertex>
-RenderPipeline RendererStorage::pipeline(RenderState& st, const ShaderPair &sh) {
+RenderPipeline RendererStorage::pipeline(RenderState& st, const ShaderPair &sh) const {
   return device.pipeline<Vertex>(Triangles,st,sh.vs,sh.fs);
   }
@@ -7,19 +7,30 @@
 #include <Tempest/Device>
 #include <Tempest/Assets>
 
+#include <mutex>
+
 class Gothic;
 
 class RendererStorage {
   public:
     RendererStorage(Tempest::Device& device, Gothic& gothic);
 
+    // rarely used permutations: created on first request, usually on world loading thread
+    enum Permutation : uint8_t {
+      ObjectWater,
+      AnimWater,
+      ObjectMAdd,
+      AnimMAdd,
+      PermutationCount
+      };
+    const Tempest::RenderPipeline& permutation(Permutation p) const;
+
     Tempest::Device&        device;
 
     Tempest::RenderPipeline pAnim,   pAnimG,   pAnimAt,   pAnimAtG,   pAnimLt,   pAnimAtLt;
     Tempest::RenderPipeline pObject, pObjectG, pObjectAt, pObjectAtG, pObjectLt, pObjectAtLt;
 
-    Tempest::RenderPipeline pObjectAlpha, pAnimAlpha, pObjectWater;
-    Tempest::RenderPipeline pObjectMAdd,  pAnimMAdd,  pAnimWater;
+    Tempest::RenderPipeline pObjectAlpha, pAnimAlpha;
 
     Tempest::RenderPipeline pObjectSh, pObjectAtSh;
     Tempest::RenderPipeline pAnimSh,   pAnimAtSh;
@@ -44,5 +55,10 @@ class RendererStorage {
       };
 
     template<class Vertex>
-    Tempest::RenderPipeline pipeline(Tempest::RenderState& st, const ShaderPair &fs);
+    Tempest::RenderPipeline pipeline(Tempest::RenderState& st, const ShaderPair &fs) const;
+    Tempest::RenderPipeline implPermutation(Permutation p) const;
+
+    mutable Tempest::RenderPipeline rare     [PermutationCount];
+    mutable bool                    rareReady[PermutationCount] = {};
+    mutable std::mutex              rareSync;
   };
@@ -4,8 +4,10 @@
 #include <Tempest/Uniforms>
 #include <Tempest/Device>
 
+#include <algorithm>
 #include <cassert>
 
+#include "utils/frameprofiler.h"
 #include "resources.h"
 
 template<class Ubo>
@@ -19,21 +21,31 @@ class UboStorage {
     const
     Tempest::UniformBuffer<Ubo>& operator[](size_t i) const { return pf[i].uboData; }
 
+    // thread-safe for distinct elements
     void                     markAsChanged(size_t elt);
     Ubo&                     element(size_t i){ return obj[i]; }
 
     void                     reserve(size_t sz);
 
   private:
+    enum {
+      MinCapacity = 32,
+      MaxGap      = 4, // clean elements, that are uploaded anyway to merge two dirty ranges
+      };
+    static_assert(Resources::MaxFramesInFlight<=8, "dirty mask is 8 bit wide");
+
     struct PerFrame final {
       Tempest::UniformBuffer<Ubo>  uboData;
-      std::atomic_bool             uboChanged{false};  // invalidate ubo array
+      std::atomic_bool             uboChanged{false};  // any element of 'dirty' has bit of this frame
       };
 
+    void                        grow();
+    void                        upload(PerFrame& frame, size_t begin, size_t end);
+
     PerFrame                    pf[Resources::MaxFramesInFlight];
     std::vector<Ubo>            obj;
+    std::vector<uint8_t>        dirty;    // per element: bit per frame in flight, that has to be uploaded
     std::vector<size_t>         freeList;
-    size_t                      updatesTotal=0; // perf statistic
   };
 
 template<class Ubo>
@@ -42,14 +54,12 @@ UboStorage<Ubo>::UboStorage() {
 
 template<class Ubo>
 size_t UboStorage<Ubo>::alloc() {
-  if(freeList.size()>0){
-    size_t id=freeList.back();
-    freeList.pop_back();
-    return id;
-    }
-  obj.resize(obj.size()+1);
-  markAsChanged(obj.size()-1);
-  return obj.size()-1;
+  if(freeList.size()==0)
+    grow();
+  size_t id=freeList.back();
+  freeList.pop_back();
+  markAsChanged(id);
+  return id;
   }
 
 template<class Ubo>
@@ -59,26 +69,71 @@ void UboStorage<Ubo>::free(const size_t objId) {
   }
 
 template<class Ubo>
-void UboStorage<Ubo>::markAsChanged(size_t /*elt*/) {
+void UboStorage<Ubo>::grow() {
+  // grow with headroom: gpu buffers are recreated (and descriptors invalidated) only here
+  const size_t sz  = obj.size();
+  const size_t cap = std::max<size_t>(MinCapacity,sz+sz/2);
+  obj  .resize(cap);
+  dirty.resize(cap,0);
+  for(size_t i=cap; i>sz; ) {
+    --i;
+    freeList.push_back(i);
+    }
+  }
+
+template<class Ubo>
+void UboStorage<Ubo>::markAsChanged(size_t elt) {
+  dirty[elt] = uint8_t((1u<<Resources::MaxFramesInFlight)-1u);
   for(auto& i:pf)
     i.uboChanged=true;
   }
 
+template<class Ubo>
+void UboStorage<Ubo>::upload(PerFrame& frame, size_t begin, size_t end) {
+  frame.uboData.update(obj.data()+begin,begin,end-begin);
+  FrameProfiler::count(FrameProfiler::UboUploadBytes, (end-begin)*sizeof(Ubo));
+  FrameProfiler::count(FrameProfiler::UboUploadRanges,1);
+  }
+
 template<class Ubo>
 bool UboStorage<Ubo>::commitUbo(Tempest::Device& device,uint8_t fId) {
-  auto&        frame   = pf[fId];
-  const bool   realloc = frame.uboData.size()!=obj.size();
+  auto&         frame   = pf[fId];
+  const bool    realloc = frame.uboData.size()!=obj.size();
+  const uint8_t bit     = uint8_t(1u<<fId);
   if(!frame.uboChanged)
     return false;
-  updatesTotal++;
-  if(realloc)
-    frame.uboData = device.ubo<Ubo>(obj.data(),obj.size()); else
-    frame.uboData.update(obj.data(),0,obj.size());
   frame.uboChanged = false;
-  return realloc;
+
+  if(realloc) {
+    frame.uboData = device.ubo<Ubo>(obj.data(),obj.size());
+    for(auto& d:dirty)
+      d = uint8_t(d & ~bit);
+    FrameProfiler::count(FrameProfiler::UboUploadBytes, obj.size()*sizeof(Ubo));
+    FrameProfiler::count(FrameProfiler::UboUploadRanges,1);
+    return true;
+    }
+
+  size_t begin = 0, end = 0;
+  for(size_t i=0; i<dirty.size(); ++i) {
+    if((dirty[i] & bit)==0)
+      continue;
+    dirty[i] = uint8_t(dirty[i] & ~bit);
+    if(end>begin && i-end>MaxGap) {
+      upload(frame,begin,end);
+      begin = i;
+      }
+    else if(end==begin) {
+      begin = i;
+      }
+    end = i+1;
+    }
+  if(end>begin)
+    upload(frame,begin,end);
+  return false;
   }
 
 template<class Ubo>
 void UboStorage<Ubo>::reserve(size_t sz){
-  obj.reserve(sz);
+  obj  .reserve(sz);
+  dirty.reserve(sz);
   }
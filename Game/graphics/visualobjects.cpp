@@ -6,6 +6,7 @@
 #include "graphics/dynamic/painter3d.h"
 #include "utils/workers.h"
 #include "rendererstorage.h"
+#include "utils/frameprofiler.h"
 
 using namespace Tempest;
 
@@ -34,6 +35,13 @@ ObjectsBucket::Item VisualObjects::get(const StaticMesh &mesh, const Material& m
   auto&        bucket = getBucket(mat,staticDraw ? ObjectsBucket::Static : ObjectsBucket::Movable);
   if(bucket.size()==0)
     index.clear();
+  if(staticDraw && mesh.isBatchable()) {
+    for(size_t i=0; i<mesh.sub.size(); ++i)
+      if(&mesh.sub[i].ibo==&ibo) {
+        const size_t id = bucket.alloc(mesh.vbo,ibo,mesh,i,mesh.bbox);
+        return ObjectsBucket::Item(bucket,id);
+        }
+    }
   const size_t id     = bucket.alloc(mesh.vbo,ibo,mesh.bbox);
   return ObjectsBucket::Item(bucket,id);
   }
@@ -52,7 +60,8 @@ ObjectsBucket::Item VisualObjects::get(const AnimMesh &mesh, const Material& mat
   }
 
 ObjectsBucket::Item VisualObjects::get(Tempest::VertexBuffer<Resources::Vertex>& vbo, Tempest::IndexBuffer<uint32_t>& ibo,
-                                       const Material& mat, const Bounds& bbox) {
+                                       const Material& mat, const Bounds& bbox,
+                                       const std::vector<PackedMesh::Cluster>& clusters) {
   if(mat.tex==nullptr) {
     Tempest::Log::e("no texture?!");
     return ObjectsBucket::Item();
@@ -60,7 +69,7 @@ ObjectsBucket::Item VisualObjects::get(Tempest::VertexBuffer<Resources::Vertex>&
   auto& bucket = getBucket(mat,ObjectsBucket::Static);
   if(bucket.size()==0)
     index.clear();
-  const size_t id     = bucket.alloc(vbo,ibo,bbox);
+  const size_t id     = bucket.alloc(vbo,ibo,bbox,clusters.data(),clusters.size());
   return ObjectsBucket::Item(bucket,id);
   }
 
@@ -99,13 +108,17 @@ void VisualObjects::draw(Tempest::Encoder<Tempest::CommandBuffer>& enc, Painter3
   sky.drawFog(enc,fId);
   }
 
-void VisualObjects::drawGBuffer(Tempest::Encoder<CommandBuffer>& enc, Painter3d& painter, uint8_t fId) {
+void VisualObjects::visibilityPass(const Painter3d* view[]) {
+  FrameProfiler::Scope scope("VisualObjects::visibilityPass");
   mkIndex();
-
-  Workers::parallelFor(index,[&painter](ObjectsBucket* c){
-    c->visibilityPass(painter);
+  Workers::parallelFor(index,[view](ObjectsBucket* c){
+    c->visibilityPass(view);
     });
+  }
 
+void VisualObjects::drawGBuffer(Tempest::Encoder<CommandBuffer>& enc, Painter3d& /*painter*/, uint8_t fId) {
+  FrameProfiler::Scope scope("VisualObjects::drawGBuffer");
+  mkIndex();
   commitUbo(fId);
 
   for(size_t i=0;i<lastSolidBucket;++i) {
@@ -114,18 +127,10 @@ void VisualObjects::drawGBuffer(Tempest::Encoder<CommandBuffer>& enc, Painter3d&
     }
   }
 
-void VisualObjects::drawShadow(Tempest::Encoder<Tempest::CommandBuffer>& enc, Painter3d& painter, uint8_t fId, int layer) {
-  if(layer+1==Resources::ShadowLayers) {
-    mkIndex();
-    Workers::parallelFor(index.data(),index.data()+lastSolidBucket,[&painter](ObjectsBucket* c){
-      c->visibilityPass(painter);
-      });
-    commitUbo(fId);
-    } else {
-    Workers::parallelFor(index.data(),index.data()+lastSolidBucket,[&painter](ObjectsBucket* c){
-      c->visibilityPassAnd(painter);
-      });
-    }
+void VisualObjects::drawShadow(Tempest::Encoder<Tempest::CommandBuffer>& enc, Painter3d& /*painter*/, uint8_t fId, int layer) {
+  FrameProfiler::Scope scope("VisualObjects::drawShadow");
+  mkIndex();
+  commitUbo(fId);
 
   for(size_t i=0;i<lastSolidBucket;++i) {
     auto c = index[i];
@@ -133,6 +138,11 @@ void VisualObjects::drawShadow(Tempest::Encoder<Tempest::CommandBuffer>& enc, Pa
     }
   }
 
+void VisualObjects::dropEmptyBuckets() {
+  buckets.remove_if([](const ObjectsBucket& b){ return b.size()==0; });
+  index.clear();
+  }
+
 void VisualObjects::setWorld(const World& world) {
   sky.setWorld(world);
   }
@@ -13,16 +13,22 @@ class VisualObjects final {
     ObjectsBucket::Item get(const StaticMesh& mesh, const Material& mat, const Tempest::IndexBuffer<uint32_t>& ibo, bool staticDraw);
     ObjectsBucket::Item get(const AnimMesh&   mesh, const Material& mat, const Tempest::IndexBuffer<uint32_t>& ibo);
     ObjectsBucket::Item get(Tempest::VertexBuffer<Resources::Vertex>& vbo, Tempest::IndexBuffer<uint32_t>& ibo,
-                            const Material& mat, const Bounds& bbox);
+                            const Material& mat, const Bounds& bbox,
+                            const std::vector<PackedMesh::Cluster>& clusters = {});
     ObjectsBucket::Item get(const Tempest::VertexBuffer<Resources::Vertex>* vbo[],
                             const Material& mat, const Bounds& bbox);
 
     void setupUbo();
     void preFrameUpdate(uint8_t fId);
+    // culls all views of frame at once: view[ObjectsBucket::V_Count], shadow cascades and main
+    void visibilityPass(const Painter3d* view[]);
     void draw          (Tempest::Encoder<Tempest::CommandBuffer>& enc, Painter3d& painter, uint8_t fId);
     void drawGBuffer   (Tempest::Encoder<Tempest::CommandBuffer>& enc, Painter3d& painter, uint8_t fId);
     void drawShadow    (Tempest::Encoder<Tempest::CommandBuffer>& enc, Painter3d& painter, uint8_t fId, int layer=0);
 
+    // releases buckets without objects; gpu must be idle
+    void dropEmptyBuckets();
+
     void setWorld   (const World& world);
     void setDayNight(float dayF);
 
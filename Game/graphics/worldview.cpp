@@ -8,6 +8,7 @@
 #include "world/npc.h"
 #include "utils/gthfont.h"
 #include "rendererstorage.h"
+#include "utils/frameprofiler.h"
 
 using namespace Tempest;
 
@@ -41,6 +42,7 @@ const LightSource &WorldView::mainLight() const {
   }
 
 void WorldView::tick(uint64_t /*dt*/) {
+  FrameProfiler::Scope scope("WorldView::tick");
   auto pl = owner.player();
   if(pl!=nullptr) {
     pfxGroup.setViewerPos(pl->position());
@@ -74,7 +76,9 @@ LightGroup::Light WorldView::getLight(const ZenLoad::zCVobData& vob) {
 
 void WorldView::setModelView(const Matrix4x4& view, const Tempest::Matrix4x4* shadow, size_t shCount) {
   updateLight();
-  sGlobal.setModelView(viewProj(view),shadow,shCount);
+  auto vp = viewProj(view);
+  viewFrustrum.make(vp);
+  sGlobal.setModelView(vp,shadow,shCount);
   }
 
 void WorldView::setFrameGlobals(const Texture2d& shadow, uint64_t tickCount, uint8_t fId) {
@@ -116,6 +120,13 @@ void WorldView::dbgLights(Painter& p) const {
   sGlobal.lights.dbgLights(p,sGlobal.viewProject(),vpWidth,vpHeight);
   }
 
+void WorldView::visibilityPass(const Painter3d& main, const Painter3d* shadow[]) {
+  static_assert(ObjectsBucket::V_Shadow0==0 && ObjectsBucket::V_Shadow1==1, "shadow view must match shadow layer");
+  static_assert(ObjectsBucket::V_Main==Resources::ShadowLayers, "one view per shadow layer");
+  const Painter3d* view[ObjectsBucket::V_Count] = {shadow[0],shadow[1],&main};
+  visuals.visibilityPass(view);
+  }
+
 void WorldView::drawShadow(Tempest::Encoder<CommandBuffer>& cmd, Painter3d& painter, uint8_t fId, uint8_t layer) {
   visuals.drawShadow(cmd,painter,fId,layer);
   }
@@ -9,6 +9,7 @@
 #include "graphics/mesh/landscape.h"
 #include "graphics/meshobjects.h"
 #include "graphics/pfxobjects.h"
+#include "graphics/dynamic/frustrum.h"
 #include "lightsource.h"
 #include "sceneglobals.h"
 #include "visualobjects.h"
@@ -28,6 +29,7 @@ class WorldView {
 
     Tempest::Matrix4x4        viewProj(const Tempest::Matrix4x4 &view) const;
     const Tempest::Matrix4x4& projective() const { return proj; }
+    const Frustrum&           frustrum() const { return viewFrustrum; }
     const LightSource&              mainLight() const;
 
     void tick(uint64_t dt);
@@ -40,6 +42,7 @@ class WorldView {
     void setGbuffer     (const Tempest::Texture2d& lightingBuf, const Tempest::Texture2d& diffuse, const Tempest::Texture2d& norm, const Tempest::Texture2d& depth);
 
     void dbgLights    (Tempest::Painter& p) const;
+    void visibilityPass(const Painter3d& main, const Painter3d* shadow[]);
     void drawShadow   (Tempest::Encoder<Tempest::CommandBuffer> &cmd, Painter3d& painter, uint8_t frameId, uint8_t layer);
     void drawGBuffer  (Tempest::Encoder<Tempest::CommandBuffer> &cmd, Painter3d& painter, uint8_t frameId);
     void drawMain     (Tempest::Encoder<Tempest::CommandBuffer> &cmd, Painter3d& painter, uint8_t frameId);
@@ -68,6 +71,7 @@ class WorldView {
     Landscape               land;
 
     Tempest::Matrix4x4      proj;
+    Frustrum                viewFrustrum;
     uint32_t                vpWidth=0;
     uint32_t                vpHeight=0;
 
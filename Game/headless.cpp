@@ -0,0 +1,442 @@
+#include "headless.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+#include <zenload/zenParser.h>
+#include <zenload/zCMesh.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#include "game/serialize.h"
+#include "graphics/mesh/animationsolver.h"
+#include "graphics/mesh/pose.h"
+#include "graphics/mesh/skeleton.h"
+#include "graphics/mesh/submesh/packedmesh.h"
+#include "graphics/mesh/submesh/vertexcodec.h"
+#include "world/world.h"
+#include "world/npc.h"
+#include "world/item.h"
+#include "utils/fileext.h"
+#include "utils/allocstat.h"
+#include "utils/frameprofiler.h"
+#include "utils/workers.h"
+#include "gothic.h"
+
+using namespace Tempest;
+
+static uint64_t hashBytes(uint64_t h, const void* data, size_t sz) {
+  auto b = reinterpret_cast<const uint8_t*>(data);
+  for(size_t i=0; i<sz; ++i) {
+    h ^= b[i];
+    h *= 0x100000001b3ull;
+    }
+  return h;
+  }
+
+template<class T>
+static uint64_t hashValue(uint64_t h, const T& v) {
+  return hashBytes(h,&v,sizeof(v));
+  }
+
+static double toMs(uint64_t ns) {
+  return double(ns)/1000000.0;
+  }
+
+Headless::Headless(Gothic& gothic, Device& device)
+  :gothic(gothic), storage(device,gothic) {
+  }
+
+bool Headless::load() {
+  std::unique_ptr<GameSession> game;
+  try {
+    if(!gothic.defaultSave().empty()) {
+      RFile     file(gothic.defaultSave());
+      Serialize s(file);
+      game.reset(new GameSession(gothic,storage,s));
+      } else {
+      game.reset(new GameSession(gothic,storage,gothic.defaultWorld()));
+      }
+    }
+  catch(std::exception& e) {
+    Log::e("headless: unable to load world: ",e.what());
+    return false;
+    }
+  gothic.setGame(std::move(game));
+  return true;
+  }
+
+int Headless::exec() {
+  using namespace std::chrono;
+
+  if(gothic.isVertexCheckMode())
+    return vertexCheck();
+  if(gothic.isTextureCheckMode())
+    return textureCheck();
+  if(gothic.isPackCheckMode())
+    return packCheck();
+  if(gothic.isBindCheckMode())
+    return bindCheck();
+  if(gothic.isPoseCheckMode())
+    return poseCheck();
+
+  if(!load())
+    return 1;
+
+  World* world = gothic.world();
+  if(world==nullptr)
+    return 1;
+
+  auto& prof = world->script().profiler();
+  prof.setEnabled(true);
+
+  const uint32_t       count   = gothic.headlessTickCount();
+  const World::TickTime begin  = world->tickTime();
+  uint64_t             tickNs  = 0;
+  uint64_t             animNs  = 0;
+  uint32_t             done    = 0;
+
+  for(; done<count; ++done) {
+    auto t0 = steady_clock::now();
+    gothic.tick(SimStep);
+    auto t1 = steady_clock::now();
+    if(gothic.world()!=world || gothic.checkLoading()!=Gothic::LoadState::Idle) {
+      Log::e("headless: world has been changed at tick ",done,", stopping");
+      world = nullptr;
+      break;
+      }
+    gothic.updateAnimation(1.f);
+    auto t2 = steady_clock::now();
+
+    tickNs += uint64_t(duration_cast<nanoseconds>(t1-t0).count());
+    animNs += uint64_t(duration_cast<nanoseconds>(t2-t1).count());
+    }
+
+  if(world==nullptr)
+    return 1;
+
+  const World::TickTime& end = world->tickTime();
+  char buf[256]={};
+
+  std::snprintf(buf,sizeof(buf),"headless: %u ticks of %dms, seed = %u",done,int(SimStep),gothic.randomSeed());
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  total     = %10.2fms (%.3fms per tick)",toMs(tickNs+animNs),toMs(tickNs+animNs)/double(std::max(done,1u)));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  objects   = %10.2fms (npc ai, triggers)",toMs(end.objects-begin.objects));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  script    = %10.2fms",toMs(prof.totalTime()));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  physics   = %10.2fms",toMs(end.physics-begin.physics));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  view      = %10.2fms",toMs(end.view-begin.view));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  sound     = %10.2fms",toMs(end.sound-begin.sound));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  animation = %10.2fms",toMs(animNs));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"  checksum  = %016llx",static_cast<unsigned long long>(checksum(*world)));
+  Log::i(buf);
+
+  if(gothic.isProfileMode())
+    FrameProfiler::saveTrace("frame_profile.json");
+  return 0;
+  }
+
+uint64_t Headless::checksum(World& world) {
+  uint64_t h = 0xcbf29ce484222325ull;
+  h = hashValue(h,world.tickCount());
+  h = hashValue(h,world.time().toInt());
+
+  for(uint32_t i=0; ; ++i) {
+    auto npc = world.npcById(i);
+    if(npc==nullptr)
+      break;
+    auto pos = npc->position();
+    h = hashValue(h,npc->handle()->instanceSymbol);
+    h = hashValue(h,pos.x);
+    h = hashValue(h,pos.y);
+    h = hashValue(h,pos.z);
+    h = hashValue(h,npc->attribute(Npc::ATR_HITPOINTS));
+    }
+
+  for(uint32_t i=0; ; ++i) {
+    auto itm = world.itmById(i);
+    if(itm==nullptr)
+      break;
+    auto pos = itm->position();
+    h = hashValue(h,itm->handle()->instanceSymbol);
+    h = hashValue(h,pos.x);
+    h = hashValue(h,pos.y);
+    h = hashValue(h,pos.z);
+    }
+  return h;
+  }
+
+int Headless::vertexCheck() {
+  // packs skinned meshes of all game archives with VertexCodec and reports size and reconstruction error
+  size_t srcTotal = 0, dstTotal = 0, meshes = 0;
+  float  posMax = 0, nrmMax = 0, uvMax = 0, wMax = 0;
+  char   buf[512]={};
+
+  for(auto& name:Resources::vdfsIndex().getKnownFiles()) {
+    if(!FileExt::hasExt(name,"MDM") && !FileExt::hasExt(name,"MDL"))
+      continue;
+    try {
+      ZenLoad::zCModelMeshLib lib(name,Resources::vdfsIndex(),1.f);
+      for(auto& mesh:lib.getMeshes()) {
+        ZenLoad::PackedSkeletalMesh pack;
+        mesh.packMesh(pack,1.f);
+
+        float pos = 0, nrm = 0, uv = 0, w = 0;
+        auto  src = reinterpret_cast<const VertexCodec::Skinned*>(pack.vertices.data());
+        for(size_t i=0; i<pack.vertices.size(); ++i) {
+          auto& a = src[i];
+          auto  b = VertexCodec::unpack(VertexCodec::pack(a));
+          for(int k=0; k<4; ++k) {
+            if(a.weights[k]>0.f)
+              for(int c=0; c<3; ++c)
+                pos = std::max(pos,std::abs(a.pos[k][c]-b.pos[k][c]));
+            w = std::max(w,std::abs(a.weights[k]-b.weights[k]));
+            }
+          float l = std::sqrt(a.norm[0]*a.norm[0]+a.norm[1]*a.norm[1]+a.norm[2]*a.norm[2]);
+          if(l>0.f) {
+            float d = (a.norm[0]*b.norm[0]+a.norm[1]*b.norm[1]+a.norm[2]*b.norm[2])/l;
+            nrm = std::max(nrm,std::acos(std::min(std::max(d,-1.f),1.f))*180.f/3.14159265f);
+            }
+          uv = std::max(uv,std::max(std::abs(a.uv[0]-b.uv[0]),std::abs(a.uv[1]-b.uv[1])));
+          }
+
+        const size_t srcSz = pack.vertices.size()*sizeof(VertexCodec::Skinned);
+        const size_t dstSz = pack.vertices.size()*sizeof(Resources::VertexA);
+        std::snprintf(buf,sizeof(buf),"vtxcheck: %-32s %6u vert, %8u -> %8u bytes, err pos=%.4f nrm=%.3fdeg uv=%.5f w=%.4f",
+                      name.c_str(),unsigned(pack.vertices.size()),unsigned(srcSz),unsigned(dstSz),
+                      double(pos),double(nrm),double(uv),double(w));
+        Log::i(buf);
+
+        srcTotal += srcSz;
+        dstTotal += dstSz;
+        posMax    = std::max(posMax,pos);
+        nrmMax    = std::max(nrmMax,nrm);
+        uvMax     = std::max(uvMax,uv);
+        wMax      = std::max(wMax,w);
+        meshes++;
+        }
+      }
+    catch(...) {
+      Log::e("vtxcheck: unable to load \"",name,"\"");
+      }
+    }
+
+  std::snprintf(buf,sizeof(buf),"vtxcheck: %u meshes, %.2fMiB -> %.2fMiB, max err pos=%.4f nrm=%.3fdeg uv=%.5f w=%.4f",
+                unsigned(meshes),double(srcTotal)/(1024.0*1024.0),double(dstTotal)/(1024.0*1024.0),
+                double(posMax),double(nrmMax),double(uvMax),double(wMax));
+  Log::i(buf);
+  return 0;
+  }
+
+int Headless::textureCheck() {
+  using namespace std::chrono;
+  // decodes and uploads every texture of game archives, in batches, same way as world loading does
+  enum { BatchSize = 256 };
+
+  std::vector<std::string> names;
+  size_t                   srcBytes = 0;
+  for(auto& name:Resources::vdfsIndex().getKnownFiles()) {
+    if(FileExt::hasExt(name,"TEX") && name.size()>6 && name.compare(name.size()-6,6,"-C.TEX")==0) {
+      names.push_back(name.substr(0,name.size()-6)+".TGA");
+      srcBytes += Resources::getFileView(name).size;
+      }
+    }
+
+  size_t   gpuBytes = 0;
+  uint64_t ns       = 0;
+  for(size_t i=0; i<names.size(); i+=BatchSize) {
+    std::vector<std::string> batch(names.begin()+std::ptrdiff_t(i),names.begin()+std::ptrdiff_t(std::min<size_t>(i+BatchSize,names.size())));
+    auto t0 = steady_clock::now();
+    gpuBytes += Resources::preloadTextures(batch);
+    auto t1 = steady_clock::now();
+    ns += uint64_t(duration_cast<nanoseconds>(t1-t0).count());
+
+    // keep gpu memory in budget
+    Resources::markUnused();
+    Resources::evictUnused();
+    }
+
+  const double sec = double(ns)/1e9;
+  char buf[256]={};
+  std::snprintf(buf,sizeof(buf),"texcheck: %u textures in %.2fs (%.1f tex/s, %.1f MiB/s of source data)",
+                unsigned(names.size()),sec,double(names.size())/std::max(sec,1e-9),double(srcBytes)/(1024.0*1024.0)/std::max(sec,1e-9));
+  Log::i(buf);
+  std::snprintf(buf,sizeof(buf),"texcheck: source = %.2fMiB, gpu = %.2fMiB",
+                double(srcBytes)/(1024.0*1024.0),double(gpuBytes)/(1024.0*1024.0));
+  Log::i(buf);
+  return 0;
+  }
+
+int Headless::packCheck() {
+  using namespace std::chrono;
+  // packs mesh of default world, same way as world loading does on a cache miss
+  enum { Runs = 5 };
+
+  std::unique_ptr<ZenLoad::ZenParser> parser;
+  ZenLoad::zCMesh*                    mesh = nullptr;
+  try {
+    parser.reset(new ZenLoad::ZenParser(gothic.defaultWorld(),Resources::vdfsIndex()));
+    parser->readHeader();
+    ZenLoad::oCWorldData world;
+    parser->readWorld(world,gothic.version().game==2);
+    mesh = parser->getWorldMesh();
+    }
+  catch(std::exception& e) {
+    Log::e("packcheck: unable to load world: ",e.what());
+    return 1;
+    }
+
+  static const std::pair<PackedMesh::PkgType,const char*> types[] = {
+    {PackedMesh::PK_VisualLnd,   "visual-lnd"  },
+    {PackedMesh::PK_PhysicZoned, "physic-zoned"},
+    {PackedMesh::PK_Physic,      "physic"      },
+    };
+
+  char buf[256]={};
+  for(auto& t:types) {
+    uint64_t best = uint64_t(-1), total = 0;
+    size_t   vert = 0, ind = 0, sub = 0;
+    for(int i=0; i<Runs; ++i) {
+      auto t0 = steady_clock::now();
+      PackedMesh pm(*mesh,t.first);
+      auto t1 = steady_clock::now();
+      const uint64_t ns = uint64_t(duration_cast<nanoseconds>(t1-t0).count());
+      best   = std::min(best,ns);
+      total += ns;
+      vert   = pm.vertices.size();
+      sub    = pm.subMeshes.size();
+      ind    = 0;
+      for(auto& s:pm.subMeshes)
+        ind += s.indices.size();
+      }
+    std::snprintf(buf,sizeof(buf),"packcheck: %-12s %8u vert, %9u ind, %5u submeshes, best = %8.2fms, avg = %8.2fms",
+                  t.second,unsigned(vert),unsigned(ind),unsigned(sub),toMs(best),toMs(total/uint64_t(Runs)));
+    Log::i(buf);
+    }
+  return 0;
+  }
+
+int Headless::bindCheck() {
+  using namespace std::chrono;
+  // lookups in bindCache-like map: few skeletons, many meshes per skeleton. Keys are never dereferenced
+  enum { Skeletons = 8, MeshPerSkeleton = 1024, Rounds = 64 };
+
+  // previous hash: skeleton pointer only
+  struct SkeletonHash {
+    size_t operator()(const Resources::BindK& b) const { return std::uintptr_t(std::get<0>(b)); }
+    };
+
+  std::vector<Resources::BindK> keys;
+  keys.reserve(Skeletons*MeshPerSkeleton);
+  for(uintptr_t s=0; s<Skeletons; ++s)
+    for(uintptr_t m=0; m<MeshPerSkeleton; ++m) {
+      // spacing of heap allocations of similar size
+      auto sk = reinterpret_cast<const Skeleton*> (0x10000000+s*0x2c0);
+      auto pm = reinterpret_cast<const ProtoMesh*>(0x20000000+(s*MeshPerSkeleton+m)*0x1b0);
+      keys.emplace_back(sk,pm);
+      }
+
+  char buf[256]={};
+  auto run = [&](auto map, const char* name) {
+    for(size_t i=0; i<keys.size(); ++i)
+      map[keys[i]] = uint32_t(i);
+
+    size_t maxBucket = 0;
+    for(size_t i=0; i<map.bucket_count(); ++i)
+      maxBucket = std::max(maxBucket,map.bucket_size(i));
+
+    uint64_t sum = 0;
+    auto     t0  = steady_clock::now();
+    for(int r=0; r<Rounds; ++r)
+      for(auto& k:keys)
+        sum += map.find(k)->second;
+    auto     t1  = steady_clock::now();
+    const double ns = double(duration_cast<nanoseconds>(t1-t0).count())/double(keys.size()*Rounds);
+    std::snprintf(buf,sizeof(buf),"bindcheck: %-9s %u keys, max bucket = %5u, lookup = %8.2fns (%llu)",
+                  name,unsigned(keys.size()),unsigned(maxBucket),ns,static_cast<unsigned long long>(sum));
+    Log::i(buf);
+    };
+
+  run(std::unordered_map<Resources::BindK,uint32_t,SkeletonHash>(),  "skeleton");
+  run(std::unordered_map<Resources::BindK,uint32_t,Resources::Hash>(),"combined");
+  return 0;
+  }
+
+int Headless::poseCheck() {
+  using namespace std::chrono;
+  // evaluates humanoid poses from MAN data of HUMANS.MDS, same way as WorldObjects::updateAnimation does
+  enum { PoseCount = 1024, Ticks = 256 };
+
+  static const char* names[] = {
+    "S_RUN", "S_RUNL", "S_WALKL", "S_SNEAKL", "S_FISTRUNL", "S_1HRUNL", "S_2HRUNL", "S_BOWRUNL",
+    "S_SWIML", "S_DIVEF", "T_DANCE_01", "T_DANCE_02", "S_LGUARD", "S_HGUARD", "S_SIT", "S_FALLDN",
+    };
+
+  auto skeleton = Resources::loadSkeleton("HUMANS.MDS");
+  if(skeleton==nullptr) {
+    Log::e("posecheck: unable to load HUMANS.MDS");
+    return 1;
+    }
+
+  std::vector<const Animation::Sequence*> seq;
+  for(auto n:names)
+    if(auto sq = skeleton->sequence(n))
+      seq.push_back(sq);
+  if(seq.empty()) {
+    Log::e("posecheck: no animations found in HUMANS.MDS");
+    return 1;
+    }
+
+  AnimationSolver   solver;
+  std::vector<Pose> pose(PoseCount);
+  for(size_t i=0; i<pose.size(); ++i) {
+    // different start time, so poses are not sampled at the same frame
+    pose[i].setSkeleton(skeleton);
+    pose[i].startAnim(solver,seq[i%seq.size()],0,BS_NONE,Pose::Force,uint64_t(i*7)%1000);
+    }
+
+  char buf[256]={};
+  uint64_t tick = 1000;
+  auto run = [&](bool parallel, const char* name) {
+    const uint64_t alloc0 = AllocStat::count();
+    auto           t0     = steady_clock::now();
+    for(int i=0; i<Ticks; ++i) {
+      tick += SimStep;
+      if(parallel) {
+        Workers::parallelFor(pose,[t=tick](Pose& p){
+          p.update(t);
+          });
+        } else {
+        for(auto& p:pose)
+          p.update(tick);
+        }
+      }
+    auto           t1     = steady_clock::now();
+    const uint64_t alloc1 = AllocStat::count();
+
+    const double sec = double(duration_cast<nanoseconds>(t1-t0).count())/1e9;
+    std::snprintf(buf,sizeof(buf),"posecheck: %-8s %u poses x %u ticks in %8.2fms, %10.0f poses/s",
+                  name,unsigned(PoseCount),unsigned(Ticks),sec*1000.0,double(PoseCount*Ticks)/std::max(sec,1e-9));
+    Log::i(buf);
+    if(AllocStat::isEnabled()) {
+      std::snprintf(buf,sizeof(buf),"posecheck: %-8s %llu heap allocations",
+                    name,static_cast<unsigned long long>(alloc1-alloc0));
+      Log::i(buf);
+      }
+    };
+
+  std::snprintf(buf,sizeof(buf),"posecheck: %u nodes, %u animations",unsigned(skeleton->nodes.size()),unsigned(seq.size()));
+  Log::i(buf);
+  run(false,"serial");
+  run(true, "parallel");
+  return 0;
+  }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Tempest/Device>
+
+#include <cstdint>
+
+#include "graphics/rendererstorage.h"
+
+class Gothic;
+class World;
+
+// runs game simulation without window/swapchain, for cpu benchmarks and regression checks
+class Headless final {
+  public:
+    Headless(Gothic& gothic, Tempest::Device& device);
+
+    int exec();
+
+  private:
+    enum {
+      SimStep = 16, // ms, same as MainWindow
+      };
+
+    Gothic&          gothic;
+    RendererStorage  storage;
+
+    bool             load();
+    static uint64_t  checksum(World& world);
+    static int       vertexCheck();
+    static int       textureCheck();
+    int              packCheck();
+    static int       bindCheck();
+    static int       poseCheck();
+  };
@@ -11,6 +11,7 @@
 #include "utils/crashlog.h"
 #include "gothic.h"
 #include "mainwindow.h"
+#include "headless.h"
 
 const char* selectDevice(const Tempest::AbstractGraphicsApi& api) {
   auto d = api.devices();
@@ -59,6 +60,11 @@ int main(int argc,const char** argv) {
   Resources            resources{gothic,device};
   GameMusic            music(gothic);
 
+  if(gothic.isHeadlessMode()) {
+    Headless hl(gothic,device);
+    return hl.exec();
+    }
+
   MainWindow           wx(gothic,device);
   Tempest::Application app;
   return app.exec();
@@ -7,6 +7,7 @@
 #include <Tempest/Pen>
 #include <Tempest/Layout>
 #include <Tempest/Application>
+#include <Tempest/MemWriter>
 #include <Tempest/Log>
 
 #include "ui/dialogmenu.h"
@@ -18,6 +19,8 @@
 #include "gothic.h"
 #include "world/npc.h"
 #include "game/serialize.h"
+#include "utils/allocstat.h"
+#include "utils/frameprofiler.h"
 #include "utils/crashlog.h"
 #include "utils/gthfont.h"
 
@@ -204,6 +207,46 @@ void MainWindow::paintEvent(PaintEvent& event) {
 
       auto& fnt = Resources::font();
       fnt.drawText(p,5,30,fpsT);
+
+      if(world!=nullptr && gothic.isProfileMode()) {
+        auto& st = world->animationStats();
+        char  aniT[128]={};
+        std::snprintf(aniT,sizeof(aniT),"anim: full = %u, reduced = %u, far = %u, skipped = %u",
+                      st.evaluated[WorldObjects::AnimFull],st.evaluated[WorldObjects::AnimReduced],
+                      st.evaluated[WorldObjects::AnimFar],st.skipped);
+        fnt.drawText(p,5,30+int(fnt.pixelSize()),aniT);
+
+        if(AllocStat::isEnabled()) {
+          char  memT[64]={};
+          std::snprintf(memT,sizeof(memT),"allocations per tick = %llu",static_cast<unsigned long long>(tickAllocs));
+          fnt.drawText(p,5,30+2*int(fnt.pixelSize()),memT);
+          }
+
+        char  frmT[96]={};
+        std::snprintf(frmT,sizeof(frmT),"frame: p50 = %.0fms, p95 = %.0fms, p99 = %.0fms",
+                      FrameProfiler::percentile(0.5),FrameProfiler::percentile(0.95),FrameProfiler::percentile(0.99));
+        fnt.drawText(p,5,30+3*int(fnt.pixelSize()),frmT);
+
+        char  uboT[96]={};
+        std::snprintf(uboT,sizeof(uboT),"ubo upload = %.1fKb in %llu ranges",
+                      double(FrameProfiler::lastCount(FrameProfiler::UboUploadBytes))/1024.0,
+                      static_cast<unsigned long long>(FrameProfiler::lastCount(FrameProfiler::UboUploadRanges)));
+        fnt.drawText(p,5,30+4*int(fnt.pixelSize()),uboT);
+
+        char  drwT[96]={};
+        std::snprintf(drwT,sizeof(drwT),"draws = %llu for %llu objects",
+                      static_cast<unsigned long long>(FrameProfiler::lastCount(FrameProfiler::DrawCalls)),
+                      static_cast<unsigned long long>(FrameProfiler::lastCount(FrameProfiler::DrawObjects)));
+        fnt.drawText(p,5,30+5*int(fnt.pixelSize()),drwT);
+
+        int y = 30+6*int(fnt.pixelSize());
+        for(auto& i:FrameProfiler::lastFrame()) {
+          char scT[96]={};
+          std::snprintf(scT,sizeof(scT),"  %s = %.2fms",i.name,double(i.time)/1000000.0);
+          fnt.drawText(p,5,y,scT);
+          y += int(fnt.pixelSize());
+          }
+        }
     }
   }
 
@@ -413,6 +456,11 @@ void MainWindow::keyUpEvent(KeyEvent &event) {
   else if(event.key==KeyEvent::K_F5){
     gothic.quickSave();
     }
+  else if(event.key==KeyEvent::K_F8 && gothic.isProfileMode()){
+    if(auto w = gothic.world())
+      w->script().saveProfile("script_profile");
+    FrameProfiler::saveTrace("frame_profile.json");
+    }
 
   const char* menuEv=nullptr;
 
@@ -543,8 +591,27 @@ void MainWindow::tick() {
   if(gothic.isPause() || dt==0)
     return;
 
+  // fixed simulation step, independent of frame rate; time above SimMaxSteps is dropped
+  // on heavy frames, instead of slowing down all following frames with catch-up ticks
+  const uint64_t step = SimStep;
+  simTime = std::min<uint64_t>(simTime+dt,step*SimMaxSteps);
+  while(simTime>=step) {
+    simTime -= step;
+    tickSimulation(step);
+    if(gothic.checkLoading()!=Gothic::LoadState::Idle)
+      return; // world change or save has been requested
+    }
+
+  // input is sampled every render frame, to not add up to one step of latency
   if(dt>50)
     dt=50;
+  if(document.isActive())
+    clearInput();
+  tickMouse();
+  player.tickMove(dt);
+  }
+
+void MainWindow::tickSimulation(uint64_t dt) {
   dialogs.tick(dt);
   inventory.tick(dt);
   gothic.tick(dt);
@@ -553,10 +620,6 @@ void MainWindow::tick() {
     clearInput();
 
   player.tickFocus();
-  if(document.isActive())
-    clearInput();
-  tickMouse();
-  player.tickMove(dt);
   }
 
 void MainWindow::isDialogClosed(bool& ret) {
@@ -698,13 +761,20 @@ void MainWindow::saveGame(const std::string &name) {
   auto tex = renderer.screenshoot(swapchain.frameId());
   auto pm  = device.readPixels(textureCast(tex));
 
-  gothic.startSave(std::move(textureCast(tex)),[name,pm](std::unique_ptr<GameSession>&& game){
+  gothic.startSave(std::move(textureCast(tex)),[this,name,pm](std::unique_ptr<GameSession>&& game){
     if(!game)
       return std::move(game);
 
-    Tempest::WFile f(name);
-    Serialize      s(f);
+    // game is paused only for snapshot into memory; file is written in background
+    const uint64_t       time = Application::tickCount();
+    std::vector<uint8_t> data;
+    {
+    Tempest::MemWriter wr{data};
+    Serialize          s(wr);
     game->save(s,name.c_str(),pm);
+    }
+    Log::i("save \"",name,"\": snapshot ",Application::tickCount()-time,"ms");
+    gothic.writeSave(name,std::move(data));
 
     // no print yet, because threading
     // gothic.print("Game saved");
@@ -735,6 +805,8 @@ void MainWindow::onWorldLoaded() {
   device.waitIdle();
   for(auto& c:commandDynamic)
     c = device.commandBuffer();
+  // Resources::evictUnused has been called by Gothic::finishLoading, right before this
+  inventory.onAssetsEvicted();
 
   if(auto pl = gothic.player())
     pl->multSpeed(1.f);
@@ -773,15 +845,18 @@ void MainWindow::render(){
       }
 
     video.tick();
-    if(!video.isActive())
+    if(!video.isActive()) {
+      const uint64_t allocs = AllocStat::count();
       tick();
+      tickAllocs = AllocStat::count()-allocs;
+      }
 
     auto& context = fLocal[swapchain.frameId()];
     if(!context.gpuLock.wait(0))
       return;
 
     if(!video.isActive()) {
-      gothic.updateAnimation();
+      gothic.updateAnimation(float(simTime)/float(SimStep));
       followCamera();
       }
 
@@ -815,6 +890,7 @@ void MainWindow::render(){
       t = Application::tickCount();
       }
     fps.push(t-time);
+    FrameProfiler::frameEnd(t-time);
     time=t;
     }
   catch(const Tempest::DeviceLostException&) {
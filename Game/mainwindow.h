@@ -91,6 +91,7 @@ class MainWindow : public Tempest::Window {
     void render() override;
 
     void tick();
+    void tickSimulation(uint64_t dt);
     void isDialogClosed(bool& ret);
     void followCamera();
 
@@ -143,6 +144,13 @@ class MainWindow : public Tempest::Window {
     Tempest::Point            dMouse;
     PlayerControl             player;
     uint64_t                  lastTick=0;
+    uint64_t                  simTime=0;
+    uint64_t                  tickAllocs=0;
+
+    enum {
+      SimStep     = 16, // ms
+      SimMaxSteps = 3,
+      };
 
     struct Fps {
       uint64_t dt[10]={};
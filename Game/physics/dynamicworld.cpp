@@ -40,6 +40,7 @@
 #include "graphics/mesh/submesh/packedmesh.h"
 #include "world/bullet.h"
 #include "world/item.h"
+#include "utils/frameprofiler.h"
 
 const float DynamicWorld::ghostPadding=50-22.5f;
 const float DynamicWorld::ghostHeight =140;
@@ -496,7 +497,7 @@ struct DynamicWorld::BBoxList final {
   DynamicWorld&        wrld;
   };
 
-DynamicWorld::DynamicWorld(World&,const ZenLoad::zCMesh& worldMesh) {
+DynamicWorld::DynamicWorld(World&, PackedMesh&& pkg) {
   // collision configuration contains default setup for memory, collision setup
   conf.reset(new btDefaultCollisionConfiguration());
 
@@ -514,7 +515,6 @@ DynamicWorld::DynamicWorld(World&,const ZenLoad::zCMesh& worldMesh) {
   // world.reset(new btCollisionWorld(dispatcher.get(),broadphase.get(),conf.get()));
   world.reset(new BulletWorld(dispatcher.get(),broadphase.get(),solver.get(),conf.get()));
 
-  PackedMesh pkg(worldMesh,PackedMesh::PK_PhysicZoned);
   sectors.resize(pkg.subMeshes.size());
   for(size_t i=0;i<sectors.size();++i)
     sectors[i] = pkg.subMeshes[i].material.matName;
@@ -981,6 +981,7 @@ void DynamicWorld::moveBullet(BulletBody &b, float dx, float dy, float dz, uint6
   }
 
 void DynamicWorld::tick(uint64_t dt) {
+  FrameProfiler::Scope scope("DynamicWorld::tick");
   static bool dynamic = true;
 
   npcList->tickAabbs();
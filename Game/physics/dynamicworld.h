@@ -49,7 +49,7 @@ class DynamicWorld final {
     static constexpr float bulletSpeed = 3000; //per sec
     static constexpr float spellSpeed  = 1000; //per sec
 
-    DynamicWorld(World &world, const ZenLoad::zCMesh& mesh);
+    DynamicWorld(World &world, PackedMesh&& landscape);
     DynamicWorld(const DynamicWorld&)=delete;
     ~DynamicWorld();
 
@@ -17,7 +17,10 @@
 #include <zenload/zenParser.h>
 #include <zenload/ztex2dds.h>
 
+#include <chrono>
+#include <cstring>
 #include <fstream>
+#include <unordered_set>
 
 #include "graphics/mesh/submesh/staticmesh.h"
 #include "graphics/mesh/submesh/animmesh.h"
@@ -32,6 +35,8 @@
 #include "dmusic/directmusic.h"
 #include "utils/fileext.h"
 #include "utils/gthfont.h"
+#include "utils/frameprofiler.h"
+#include "utils/workers.h"
 
 #include "gothic.h"
 
@@ -50,9 +55,36 @@ static void emplaceTag(char* buf, char tag){
     }
   }
 
+size_t Resources::textureSize(const Texture2d& t) {
+  // estimation, including mip-chain
+  size_t px = size_t(t.w())*size_t(t.h());
+  if(t.format()==TextureFormat::DXT1)
+    px = px/2;
+  else if(t.format()!=TextureFormat::DXT3 && t.format()!=TextureFormat::DXT5)
+    px = px*4;
+  return px*4/3;
+  }
+
+static size_t meshSize(const ProtoMesh& m) {
+  size_t sz = 0;
+  for(auto& i:m.attach) {
+    sz += i.vbo.size()*sizeof(Resources::Vertex);
+    for(auto& s:i.sub)
+      sz += s.ibo.size()*sizeof(uint32_t);
+    }
+  for(auto& i:m.skined) {
+    sz += i.vbo.size()*sizeof(Resources::VertexA);
+    for(auto& s:i.sub)
+      sz += s.ibo.size()*sizeof(uint32_t);
+    }
+  return sz;
+  }
+
 Resources::Resources(Gothic &gothic, Tempest::Device &device)
   : device(device), gothic(gothic) {
   inst=this;
+  // resolution cap, for low-memory machines; 0 - no cap
+  texMaxSize = uint32_t(std::max(gothic.settingsGetI("ENGINE","zTexMaxSize"),0));
 
   static std::array<VertexFsq,6> fsqBuf =
    {{
@@ -72,9 +104,6 @@ Resources::Resources(Gothic &gothic, Tempest::Device &device)
   dxMusic->addPath(gothic.nestedPath({u"_work",u"Data",u"Music",u"menu_men"}, Dir::FT_Dir));
   dxMusic->addPath(gothic.nestedPath({u"_work",u"Data",u"Music",u"orchestra"},Dir::FT_Dir));
 
-  fBuff .reserve(8*1024*1024);
-  ddsBuf.reserve(8*1024*1024);
-
   {
   Pixmap pm(1,1,Pixmap::Format::RGBA);
   uint8_t* pix = reinterpret_cast<uint8_t*>(pm.data());
@@ -99,9 +128,29 @@ Resources::Resources(Gothic &gothic, Tempest::Device &device)
            std::make_tuple(bIsMod,b.time,int(b.ord));
     });
 
-  for(auto& i:archives)
-    gothicAssets.loadVDF(i.name);
-  gothicAssets.finalizeLoad();
+  gothicAssetsHash = 0xcbf29ce484222325ull;
+  std::vector<std::u16string> vdfList;
+  for(auto& i:archives) {
+    vdfList.push_back(i.name);
+    if(!mapArchive(i.name))
+      Log::e("unable to map archive: \"",TextCodec::toUtf8(i.name),"\"");
+    for(auto c:i.name)
+      gothicAssetsHash = (gothicAssetsHash^uint64_t(c))*0x100000001b3ull;
+    gothicAssetsHash = (gothicAssetsHash^uint64_t(i.time))*0x100000001b3ull;
+    }
+
+  // archive tables are parsed only, when set of archives has changed
+  uint64_t indexKey = gothicAssetsHash;
+  for(auto& i:archiveMaps)
+    indexKey = (indexKey^uint64_t(i.size()))*0x100000001b3ull;
+  if(!assetIndex.load("vdfs.idx",indexKey) || !validateIndex()) {
+    assetIndex.clear();
+    for(size_t i=0; i<archiveMaps.size(); ++i)
+      indexArchive(uint32_t(i));
+    assetIndex.finalize();
+    assetIndex.save("vdfs.idx",indexKey);
+    Log::i("asset index: ",assetIndex.size()," files, rebuilt");
+    }
 
   //for(auto& i:gothicAssets.getKnownFiles())
   //  Log::i(i);
@@ -109,12 +158,48 @@ Resources::Resources(Gothic &gothic, Tempest::Device &device)
   // auto v = getFileData("TREASURE_ADDON_01.MDL");
   // Tempest::WFile f("../../internal/TREASURE_ADDON_01.MDL");
   // f.write(v.data(),v.size());
+
+  // mapped archives are served by assetIndex; VDFS tables are needed only by ZenLoad parsers and for
+  // unmapped archives, so they are loaded in background. Started last: nothing above may throw with running thread
+  vdfsTh = std::thread([this,vdfList]() {
+    implLoadVdfs(vdfList);
+    });
   }
 
 Resources::~Resources() {
+  vdfs();
   inst=nullptr;
   }
 
+void Resources::implLoadVdfs(const std::vector<std::u16string>& archives) {
+  auto t0 = std::chrono::steady_clock::now();
+  try {
+    for(auto& i:archives)
+      gothicAssets.loadVDF(i);
+    gothicAssets.finalizeLoad();
+    }
+  catch(...) {
+    Log::e("unable to load game archives");
+    }
+  auto t1 = std::chrono::steady_clock::now();
+  Log::i("vdfs: ",archives.size()," archives loaded in ",
+         std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count(),"ms (background)");
+  }
+
+VDFS::FileIndex& Resources::vdfs() {
+  if(vdfsReady.load())
+    return gothicAssets;
+  std::lock_guard<std::mutex> guard(vdfsSync);
+  if(vdfsTh.joinable()) {
+    auto t0 = std::chrono::steady_clock::now();
+    vdfsTh.join();
+    auto t1 = std::chrono::steady_clock::now();
+    Log::i("vdfs: waited ",std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count(),"ms");
+    }
+  vdfsReady.store(true);
+  return gothicAssets;
+  }
+
 const char* Resources::renderer() {
   return inst->device.renderer();
   }
@@ -124,6 +209,92 @@ void Resources::waitDeviceIdle() {
   return inst->device.waitIdle();
   }
 
+size_t Resources::Hash::operator()(const BindK& b) const {
+  size_t h = std::hash<const Skeleton*>()(std::get<0>(b));
+  return combine(h,std::hash<const ProtoMesh*>()(std::get<1>(b)));
+  }
+
+size_t Resources::Hash::operator()(const DecalK& b) const {
+  size_t h = std::hash<const Texture2d*>()(b.mat.tex);
+  h = combine(h,std::hash<uint8_t>()(b.mat.alpha));
+  h = combine(h,std::hash<int>()(b.mat.texAniMapDirPeriod.x));
+  h = combine(h,std::hash<int>()(b.mat.texAniMapDirPeriod.y));
+  h = combine(h,std::hash<float>()(b.sX));
+  h = combine(h,std::hash<float>()(b.sY));
+  return combine(h,std::hash<bool>()(b.decal2Sided));
+  }
+
+size_t Resources::Hash::operator()(const FontK& b) const {
+  size_t h = std::hash<std::string>()(b.first);
+  return combine(h,std::hash<uint8_t>()(uint8_t(b.second)));
+  }
+
+size_t Resources::Hash::combine(size_t h, size_t v) {
+  // std::hash of pointers is identity on most implementations, so mix bits before combining
+  uint64_t x = uint64_t(v) + 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x>>30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x>>27)) * 0x94d049bb133111ebull;
+  x =  x ^ (x>>31);
+  return size_t(uint64_t(h) ^ (x + 0x9e3779b97f4a7c15ull + (uint64_t(h)<<6) + (uint64_t(h)>>2)));
+  }
+
+void Resources::markUnused() {
+  std::lock_guard<std::recursive_mutex> g(inst->sync);
+  inst->generation++;
+  }
+
+void Resources::evictUnused() {
+  std::lock_guard<std::recursive_mutex> g(inst->sync);
+  auto&        r   = *inst;
+  const size_t MiB = 1024*1024;
+  const auto   gen = r.generation;
+  r.device.waitIdle();
+
+  // dependencies first: binders -> meshes, skeletons; skeletons -> animations; meshes -> textures
+  size_t cnt = r.bindCache.evict(gen,0,[](const BindK&, const AttachBinder&){ return true; });
+
+  std::unordered_set<const void*> used;
+  r.bindCache.forEach([&](const BindK& k, const AttachBinder&){
+    used.insert(std::get<0>(k));
+    used.insert(std::get<1>(k));
+    });
+  cnt += r.aniMeshCache .evict(gen,size_t(MeshBudget)*MiB,    [&](const std::string&, const ProtoMesh& m){ return used.find(&m)==used.end(); });
+  cnt += r.skeletonCache.evict(gen,size_t(SkeletonBudget)*MiB,[&](const std::string&, const Skeleton&  s){ return used.find(&s)==used.end(); });
+
+  r.skeletonCache.forEach([&](const std::string&, const Skeleton& s){
+    used.insert(s.animation());
+    });
+  cnt += r.animCache.evict(gen,size_t(AnimationBudget)*MiB,[&](const std::string&, const Animation& a){ return used.find(&a)==used.end(); });
+
+  auto useMaterial = [&](const Material& m){
+    used.insert(m.tex);
+    for(auto i:m.frames)
+      used.insert(i);
+    };
+  auto useMesh = [&](const ProtoMesh& m){
+    for(auto& i:m.attach)
+      for(auto& s:i.sub)
+        useMaterial(s.material);
+    for(auto& i:m.skined)
+      for(auto& s:i.sub)
+        useMaterial(s.material);
+    };
+  r.aniMeshCache.forEach([&](const std::string&, const ProtoMesh& m){ useMesh(m); });
+  for(auto& i:r.decalMeshCache)
+    useMesh(*i.second);
+  cnt += r.texCache.evict(gen,size_t(TextureBudget)*MiB,[&](const std::string&, const Texture2d& t){ return used.find(&t)==used.end(); });
+
+  auto tex = r.texCache.stats(gen);
+  auto msh = r.aniMeshCache.stats(gen);
+  auto skl = r.skeletonCache.stats(gen);
+  auto ani = r.animCache.stats(gen);
+  Log::i("resources: evicted ",cnt," assets");
+  Log::i("  textures:   ",tex.resident,"/",tex.count," resident, ",tex.bytes/MiB,"MiB");
+  Log::i("  meshes:     ",msh.resident,"/",msh.count," resident, ",msh.bytes/MiB,"MiB");
+  Log::i("  skeletons:  ",skl.resident,"/",skl.count," resident, ",skl.bytes/MiB,"MiB");
+  Log::i("  animations: ",ani.resident,"/",ani.count," resident, ",ani.bytes/MiB,"MiB");
+  }
+
 static Sampler2d implShadowSampler() {
   Tempest::Sampler2d smp;
   smp.setClamping(Tempest::ClampMode::ClampToBorder);
@@ -159,6 +330,66 @@ void Resources::detectVdf(std::vector<Archive>& ret, const std::u16string &root)
     });
   }
 
+enum : uint32_t {
+  VDF_COMMENT_LENGTH   = 256,
+  VDF_SIGNATURE_LENGTH = 16,
+  VDF_HEADER_SIZE      = 296,
+  VDF_ENTRY_NAME       = 64,
+  VDF_ENTRY_SIZE       = 80,
+  VDF_ENTRY_DIR        = 0x80000000,
+  };
+
+bool Resources::mapArchive(const std::u16string& name) {
+  // unmapped archive still takes a slot, to keep archive ids stable
+  archiveMaps.emplace_back(name);
+  auto& fin = archiveMaps.back();
+  if(!fin.isOpen() || fin.size()<VDF_HEADER_SIZE ||
+     std::memcmp(fin.data()+VDF_COMMENT_LENGTH,"PSVDSC_V2.00",12)!=0) {
+    fin = MappedFile();
+    return false;
+    }
+  return true;
+  }
+
+void Resources::indexArchive(uint32_t id) {
+  auto& fin = archiveMaps[id];
+  if(!fin.isOpen())
+    return;
+
+  uint32_t       count = 0, root = 0, entrySz = 0;
+  const uint8_t* hdr   = fin.data()+VDF_COMMENT_LENGTH+VDF_SIGNATURE_LENGTH;
+  std::memcpy(&count,  hdr+0, 4);
+  std::memcpy(&root,   hdr+16,4);
+  std::memcpy(&entrySz,hdr+20,4);
+  if(entrySz!=VDF_ENTRY_SIZE || uint64_t(root)+uint64_t(count)*VDF_ENTRY_SIZE>fin.size())
+    return;
+
+  for(size_t i=0; i<count; ++i) {
+    const uint8_t* e = fin.data()+root+i*VDF_ENTRY_SIZE;
+    uint32_t offset = 0, size = 0, type = 0;
+    std::memcpy(&offset,e+VDF_ENTRY_NAME+0,4);
+    std::memcpy(&size,  e+VDF_ENTRY_NAME+4,4);
+    std::memcpy(&type,  e+VDF_ENTRY_NAME+8,4);
+    if((type & VDF_ENTRY_DIR)!=0 || uint64_t(offset)+uint64_t(size)>fin.size())
+      continue;
+
+    size_t len = VDF_ENTRY_NAME;
+    while(len>0 && (e[len-1]==' ' || e[len-1]=='\0'))
+      --len;
+    assetIndex.add(id,reinterpret_cast<const char*>(e),len,offset,size);
+    }
+  }
+
+bool Resources::validateIndex() const {
+  for(auto& e:assetIndex.all()) {
+    if(e.archive>=archiveMaps.size())
+      return false;
+    if(uint64_t(e.offset)+uint64_t(e.size)>archiveMaps[e.archive].size())
+      return false;
+    }
+  return true;
+  }
+
 const GthFont& Resources::dialogFont() {
   return font("font_old_10_white.tga",FontType::Normal);
   }
@@ -185,7 +416,11 @@ const Texture2d &Resources::fallbackBlack() {
   }
 
 VDFS::FileIndex& Resources::vdfsIndex() {
-  return inst->gothicAssets;
+  return inst->vdfs();
+  }
+
+uint64_t Resources::vdfsHash() {
+  return inst->gothicAssetsHash;
   }
 
 const Tempest::VertexBuffer<Resources::VertexFsq> &Resources::fsqVbo() {
@@ -220,56 +455,193 @@ Tempest::Texture2d* Resources::implLoadTexture(TextureCache& cache,const char* c
   if(name.size()==0)
     return nullptr;
 
-  auto it=cache.find(name);
-  if(it!=cache.end())
-    return it->second.get();
+  if(auto e=cache.find(name,generation,pinTextures))
+    return e->val.get();
 
-  if(FileExt::hasExt(name,"TGA")){
-    name.resize(name.size()+2);
-    std::memcpy(&name[0]+name.size()-6,"-C.TEX",6);
-    if(hasFile(name)) {
-      if(!getFileData(name.c_str(),fBuff)) {
-        Log::e("unable to load texture \"",name,"\"");
-        return nullptr;
+  FrameProfiler::Scope scope("Resources::loadTexture");
+  Pixmap pm;
+  if(!implDecodeTexture(name,pm)) {
+    cache.insert(name,nullptr,0,generation,pinTextures);
+    return nullptr;
+    }
+  return implUploadTexture(cache,name,pm);
+  }
+
+bool Resources::implDecodeTexture(const std::string& name, Pixmap& pm) {
+  // lock-free, unless asset is not in mapped archives
+  auto fetch = [this](uint64_t hash, const std::string& n, std::vector<uint8_t>& buf) {
+    auto view = implGetFileView(hash,n.c_str(),n.size());
+    if(view.empty()) {
+      std::lock_guard<std::recursive_mutex> g(sync);
+      view = implFileView(n.c_str(),buf);
+      }
+    return view;
+    };
+
+  // name and compiled texture share a prefix: it's hashed once for both lookups
+  std::vector<uint8_t> buf;
+  uint64_t             hash = 0;
+  if(FileExt::hasExt(name,"TGA")) {
+    const uint64_t prefix = AssetIndex::hash(name.c_str(),name.size()-4);
+    hash = AssetIndex::hash(prefix,name.c_str()+name.size()-4,4);
+
+    std::string ztex = name;
+    ztex.resize(ztex.size()+2);
+    std::memcpy(&ztex[0]+ztex.size()-6,"-C.TEX",6);
+    auto view = fetch(AssetIndex::hash(prefix,"-C.TEX",6),ztex,buf);
+    if(!view.empty()) {
+      // ZenLib converter accepts only std::vector
+      std::vector<uint8_t> zdata(view.data,view.data+view.size), dds;
+      ZenLoad::convertZTEX2DDS(zdata,dds);
+      capDds(dds,texMaxSize);
+      try {
+        Tempest::MemReader rd(dds.data(),dds.size());
+        pm = Pixmap(rd);
+        return true;
         }
-      ddsBuf.clear();
-      ZenLoad::convertZTEX2DDS(fBuff,ddsBuf);
-      auto t = implLoadTexture(cache,cname,ddsBuf);
-      if(t!=nullptr) {
-        return t;
+      catch(...) {
+        Log::e("unable to load texture \"",ztex,"\"");
         }
       }
+    } else {
+    hash = AssetIndex::hash(name.c_str(),name.size());
     }
 
-  if(getFileData(cname,fBuff))
-    return implLoadTexture(cache,cname,fBuff);
-
-  cache[name]=nullptr;
-  return nullptr;
+  auto view = fetch(hash,name,buf);
+  if(view.empty())
+    return false;
+  try {
+    Tempest::MemReader rd(view.data,view.size);
+    pm = Pixmap(rd);
+    return true;
+    }
+  catch(...) {
+    return false;
+    }
   }
 
-Texture2d *Resources::implLoadTexture(TextureCache& cache,std::string&& name,const std::vector<uint8_t> &data) {
+Texture2d* Resources::implUploadTexture(TextureCache& cache, const std::string& name, const Pixmap& pm) {
   try {
-    Tempest::MemReader rd(data.data(),data.size());
-    Tempest::Pixmap    pm(rd);
-
     std::unique_ptr<Texture2d> t{new Texture2d(device.loadTexture(pm))};
-    Texture2d* ret=t.get();
-    cache[std::move(name)] = std::move(t);
-    return ret;
+    const size_t bytes = textureSize(*t);
+    return cache.insert(name,std::move(t),bytes,generation,pinTextures);
     }
   catch(...){
+    cache.insert(name,nullptr,0,generation,pinTextures);
     return nullptr;
     }
   }
 
+void Resources::capDds(std::vector<uint8_t>& dds, uint32_t maxSize) {
+  // drops top mip-levels of DDS, while texture is bigger than maxSize; block-compressed data stays as is
+  enum : uint32_t {
+    HeaderSize      = 128,
+    DDSD_PITCH      = 0x8,
+    DDSD_LINEARSIZE = 0x80000,
+    DDPF_FOURCC     = 0x4,
+    };
+  if(maxSize==0 || dds.size()<HeaderSize || std::memcmp(dds.data(),"DDS ",4)!=0)
+    return;
+
+  auto rd = [&dds](size_t at) { uint32_t v=0; std::memcpy(&v,&dds[at],4); return v; };
+  auto wr = [&dds](size_t at, uint32_t v) { std::memcpy(&dds[at],&v,4); };
+
+  const uint32_t flags   = rd(8);
+  uint32_t       h       = rd(12);
+  uint32_t       w       = rd(16);
+  uint32_t       mips    = rd(28);
+  const uint32_t pfFlags = rd(80);
+  const uint32_t fourCC  = rd(84);
+  const uint32_t bpp     = rd(88)/8;
+
+  uint32_t block = 0;
+  if(pfFlags & DDPF_FOURCC) {
+    if(std::memcmp(&fourCC,"DXT1",4)==0)
+      block = 8;
+    else if(std::memcmp(&fourCC,"DXT3",4)==0 || std::memcmp(&fourCC,"DXT5",4)==0)
+      block = 16;
+    else
+      return;
+    }
+  else if(bpp==0) {
+    return;
+    }
+
+  auto levelSize = [block,bpp](uint32_t w, uint32_t h) -> size_t {
+    if(block>0)
+      return size_t(std::max(1u,(w+3)/4))*size_t(std::max(1u,(h+3)/4))*block;
+    return size_t(w)*size_t(h)*bpp;
+    };
+
+  size_t drop = 0;
+  while((w>maxSize || h>maxSize) && mips>1) {
+    drop += levelSize(w,h);
+    w     = std::max(1u,w/2);
+    h     = std::max(1u,h/2);
+    mips--;
+    }
+  if(drop==0 || HeaderSize+drop>dds.size())
+    return;
+
+  wr(12,h);
+  wr(16,w);
+  wr(28,mips);
+  if(flags & DDSD_LINEARSIZE)
+    wr(20,uint32_t(levelSize(w,h)));
+  else if(flags & DDSD_PITCH)
+    wr(20,w*bpp);
+  dds.erase(dds.begin()+HeaderSize,dds.begin()+std::ptrdiff_t(HeaderSize+drop));
+  }
+
+size_t Resources::preloadTextures(const std::vector<std::string>& names) {
+  struct Task {
+    const std::string* name = nullptr;
+    Pixmap             pm;
+    bool               ok   = false;
+    };
+
+  std::vector<Task> task;
+  {
+  std::lock_guard<std::recursive_mutex> g(inst->sync);
+  std::unordered_set<std::string> uniq;
+  for(auto& i:names) {
+    if(i.empty() || inst->texCache.find(i,inst->generation,false)!=nullptr || !uniq.insert(i).second)
+      continue;
+    task.emplace_back();
+    task.back().name = &i;
+    }
+  }
+
+  FrameProfiler::Scope scope("Resources::preloadTextures");
+  // decoding runs without lock; only upload and cache update are serialized
+  Workers::parallelFor(task,[](Task& t){
+    t.ok = inst->implDecodeTexture(*t.name,t.pm);
+    });
+
+  std::lock_guard<std::recursive_mutex> g(inst->sync);
+  const bool pin    = inst->pinTextures;
+  size_t     bytes  = 0;
+  inst->pinTextures = false;
+  for(auto& t:task) {
+    if(inst->texCache.find(*t.name,inst->generation,false)!=nullptr)
+      continue; // loaded by other thread in meantime
+    if(!t.ok) {
+      inst->texCache.insert(*t.name,nullptr,0,inst->generation,false);
+      continue;
+      }
+    if(auto tex = inst->implUploadTexture(inst->texCache,*t.name,t.pm))
+      bytes += textureSize(*tex);
+    }
+  inst->pinTextures = pin;
+  return bytes;
+  }
+
 ProtoMesh* Resources::implLoadMesh(const std::string &name) {
   if(name.size()==0)
     return nullptr;
 
-  auto it=aniMeshCache.find(name);
-  if(it!=aniMeshCache.end())
-    return it->second.get();
+  if(auto e=aniMeshCache.find(name,generation,false))
+    return e->val.get();
 
   if(FileExt::hasExt(name,"TGA")){
     static std::unordered_set<std::string> dec;
@@ -280,13 +652,14 @@ ProtoMesh* Resources::implLoadMesh(const std::string &name) {
     return nullptr;
     }
 
+  FrameProfiler::Scope scope("Resources::loadMesh");
   try {
     ZenLoad::PackedMesh        sPacked;
     ZenLoad::zCModelMeshLib    library;
     auto                       code=loadMesh(sPacked,library,name);
     std::unique_ptr<ProtoMesh> t{code==MeshLoadCode::Static ? new ProtoMesh(std::move(sPacked),name) : new ProtoMesh(library,name)};
-    ProtoMesh* ret=t.get();
-    aniMeshCache[name] = std::move(t);
+    const size_t bytes = meshSize(*t);
+    ProtoMesh*   ret   = aniMeshCache.insert(name,std::move(t),bytes,generation,false);
     if(code==MeshLoadCode::Error)
       throw std::runtime_error("load failed");
     return ret;
@@ -297,6 +670,28 @@ ProtoMesh* Resources::implLoadMesh(const std::string &name) {
     }
   }
 
+bool Resources::loadPackedMesh(const std::string& name, const std::string& attach, ZenLoad::PackedMesh& out) {
+  std::lock_guard<std::recursive_mutex> g(inst->sync);
+  try {
+    ZenLoad::zCModelMeshLib library;
+    auto                    code = inst->loadMesh(out,library,name);
+    if(code==MeshLoadCode::Static)
+      return attach.empty();
+    if(code!=MeshLoadCode::Dynamic)
+      return false;
+    for(auto& m:library.getAttachments())
+      if(m.first==attach) {
+        m.second.packMesh(out,1.f);
+        return true;
+        }
+    return false;
+    }
+  catch(...) {
+    Log::e("unable to load mesh \"",name,"\"");
+    return false;
+    }
+  }
+
 ProtoMesh* Resources::implDecalMesh(const ZenLoad::zCVobData& vob) {
   DecalK key;
   key.mat         = Material(vob);
@@ -347,15 +742,14 @@ Skeleton* Resources::implLoadSkeleton(std::string name) {
   FileExt::exchangeExt(name,"MDS","MDH") ||
   FileExt::exchangeExt(name,"ASC","MDL");
 
-  auto it=skeletonCache.find(name);
-  if(it!=skeletonCache.end())
-    return it->second.get();
+  if(auto e=skeletonCache.find(name,generation,false))
+    return e->val.get();
 
+  FrameProfiler::Scope scope("Resources::loadSkeleton");
   try {
-    ZenLoad::zCModelMeshLib library(name,gothicAssets,1.f);
+    ZenLoad::zCModelMeshLib library(name,vdfs(),1.f);
     std::unique_ptr<Skeleton> t{new Skeleton(library,name)};
-    Skeleton* ret=t.get();
-    skeletonCache[name] = std::move(t);
+    Skeleton* ret=skeletonCache.insert(name,std::move(t),getFileView(name).size,generation,false);
     if(!hasFile(name))
       throw std::runtime_error("load failed");
     return ret;
@@ -370,30 +764,28 @@ Animation* Resources::implLoadAnimation(std::string name) {
   if(name.size()<4)
     return nullptr;
 
-  auto it=animCache.find(name);
-  if(it!=animCache.end())
-    return it->second.get();
+  if(auto e=animCache.find(name,generation,false))
+    return e->val.get();
 
+  FrameProfiler::Scope scope("Resources::loadAnimation");
   try {
     Animation* ret=nullptr;
     if(gothic.version().game==2){
       FileExt::exchangeExt(name,"MDS","MSB") ||
       FileExt::exchangeExt(name,"MDH","MSB");
 
-      ZenLoad::ZenParser            zen(name,gothicAssets);
+      ZenLoad::ZenParser            zen(name,vdfs());
       ZenLoad::MdsParserBin         p(zen);
 
       std::unique_ptr<Animation> t{new Animation(p,name.substr(0,name.size()-4),false)};
-      ret=t.get();
-      animCache[name] = std::move(t);
+      ret=animCache.insert(name,std::move(t),getFileView(name).size,generation,false);
       } else {
       FileExt::exchangeExt(name,"MDH","MDS");
-      ZenLoad::ZenParser zen(name,gothicAssets);
+      ZenLoad::ZenParser zen(name,vdfs());
       ZenLoad::MdsParserTxt p(zen);
 
       std::unique_ptr<Animation> t{new Animation(p,name.substr(0,name.size()-4),true)};
-      ret=t.get();
-      animCache[name] = std::move(t);
+      ret=animCache.insert(name,std::move(t),getFileView(name).size,generation,false);
       }
     if(!hasFile(name))
       throw std::runtime_error("load failed");
@@ -413,11 +805,14 @@ SoundEffect *Resources::implLoadSound(const char* name) {
   if(it!=sndCache.end())
     return it->second.get();
 
-  if(!getFileData(name,fBuff))
+  FrameProfiler::Scope scope("Resources::loadSound");
+  std::vector<uint8_t> buf;
+  auto                 view = implFileView(name,buf);
+  if(view.empty())
     return nullptr;
 
   try {
-    Tempest::MemReader rd(fBuff.data(),fBuff.size());
+    Tempest::MemReader rd(view.data,view.size);
 
     auto s = sound.load(rd);
     std::unique_ptr<SoundEffect> t{new SoundEffect(std::move(s))};
@@ -440,10 +835,12 @@ Sound Resources::implLoadSoundBuffer(const char *name) {
   if(name[0]=='\0')
     return Sound();
 
-  if(!getFileData(name,fBuff))
+  std::vector<uint8_t> buf;
+  auto                 view = implFileView(name,buf);
+  if(view.empty())
     return Sound();
   try {
-    Tempest::MemReader rd(fBuff.data(),fBuff.size());
+    Tempest::MemReader rd(view.data,view.size);
     return Sound(rd);
     }
   catch(...){
@@ -498,7 +895,7 @@ GthFont &Resources::implLoadFont(const char* fname, FontType type) {
       break;
     }
 
-  auto ptr   = std::make_unique<GthFont>(fnt,tex,color,gothicAssets);
+  auto ptr   = std::make_unique<GthFont>(fnt,tex,color,vdfs());
   GthFont* f = ptr.get();
   gothicFnt[std::make_pair(fname,type)] = std::move(ptr);
   return *f;
@@ -522,8 +919,10 @@ PfxEmitterMesh* Resources::implLoadEmiterMesh(const char* name) {
   }
 
 bool Resources::hasFile(const std::string &fname) {
+  if(!getFileView(fname).empty())
+    return true;
   std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->gothicAssets.hasFile(fname);
+  return inst->vdfs().hasFile(fname);
   }
 
 const Texture2d *Resources::loadTexture(const char *name) {
@@ -590,7 +989,12 @@ Texture2d Resources::loadTexture(const Pixmap &pm) {
   }
 
 Material Resources::loadMaterial(const ZenLoad::zCMaterialData& src, bool enableAlphaTest) {
-  return Material(src,enableAlphaTest);
+  // world and mesh materials: textures are not pinned and can be evicted, once unused
+  std::lock_guard<std::recursive_mutex> g(inst->sync);
+  inst->pinTextures = false;
+  Material ret(src,enableAlphaTest);
+  inst->pinTextures = true;
+  return ret;
   }
 
 const ProtoMesh *Resources::loadMesh(const std::string &name) {
@@ -647,20 +1051,60 @@ const ProtoMesh* Resources::decalMesh(const ZenLoad::zCVobData& vob) {
   return inst->implDecalMesh(vob);
   }
 
+Resources::FileView Resources::getFileView(const char* name) {
+  return implGetFileView(name,std::strlen(name));
+  }
+
+Resources::FileView Resources::getFileView(const std::string& name) {
+  return implGetFileView(name.c_str(),name.size());
+  }
+
+Resources::FileView Resources::implGetFileView(const char* name, size_t len) {
+  return implGetFileView(AssetIndex::hash(name,len),name,len);
+  }
+
+Resources::FileView Resources::implGetFileView(uint64_t hash, const char* name, size_t len) {
+  auto e = inst->assetIndex.find(hash,name,len);
+  if(e==nullptr)
+    return FileView();
+  FileView v;
+  v.data = inst->archiveMaps[e->archive].data()+e->offset;
+  v.size = e->size;
+  return v;
+  }
+
+Resources::FileView Resources::implFileView(const char* name, std::vector<uint8_t>& fallback) {
+  auto view = getFileView(name);
+  if(!view.empty())
+    return view;
+  // archive, that is not mapped
+  fallback.clear();
+  if(!vdfs().getFileData(name,fallback))
+    return FileView();
+  view.data = fallback.data();
+  view.size = fallback.size();
+  return view;
+  }
+
 bool Resources::getFileData(const char *name, std::vector<uint8_t> &dat) {
   dat.clear();
-  return inst->gothicAssets.getFileData(name,dat);
+  auto view = getFileView(name);
+  if(!view.empty()) {
+    dat.assign(view.data,view.data+view.size);
+    return true;
+    }
+  return inst->vdfs().getFileData(name,dat);
   }
 
 std::vector<uint8_t> Resources::getFileData(const char *name) {
   std::vector<uint8_t> data;
-  inst->gothicAssets.getFileData(name,data);
+  getFileData(name,data);
   return data;
   }
 
 std::vector<uint8_t> Resources::getFileData(const std::string &name) {
   std::vector<uint8_t> data;
-  inst->gothicAssets.getFileData(name,data);
+  getFileData(name.c_str(),data);
   return data;
   }
 
@@ -680,7 +1124,7 @@ Resources::MeshLoadCode Resources::loadMesh(ZenLoad::PackedMesh& sPacked, ZenLoa
     }
 
   if(FileExt::hasExt(name,"MRM")) {
-    ZenLoad::zCProgMeshProto zmsh(name,gothicAssets);
+    ZenLoad::zCProgMeshProto zmsh(name,vdfs());
     if(zmsh.getNumSubmeshes()==0)
       return MeshLoadCode::Error;
     zmsh.packMesh(sPacked,1.f);
@@ -688,7 +1132,7 @@ Resources::MeshLoadCode Resources::loadMesh(ZenLoad::PackedMesh& sPacked, ZenLoa
     }
 
   if(FileExt::hasExt(name,"MMB")) {
-    ZenLoad::zCMorphMesh zmm(name,gothicAssets);
+    ZenLoad::zCMorphMesh zmm(name,vdfs());
     if(zmm.getMesh().getNumSubmeshes()==0)
       return MeshLoadCode::Error;
     zmm.getMesh().packMesh(sPacked,1.f);
@@ -713,20 +1157,21 @@ Resources::MeshLoadCode Resources::loadMesh(ZenLoad::PackedMesh& sPacked, ZenLoa
 
 ZenLoad::zCModelMeshLib Resources::loadMDS(std::string &name) {
   if(FileExt::exchangeExt(name,"MDMS","MDM"))
-    return ZenLoad::zCModelMeshLib(name,gothicAssets,1.f);
+    return ZenLoad::zCModelMeshLib(name,vdfs(),1.f);
   if(hasFile(name))
-    return ZenLoad::zCModelMeshLib(name,gothicAssets,1.f);
+    return ZenLoad::zCModelMeshLib(name,vdfs(),1.f);
   std::memcpy(&name[name.size()-3],"MDL",3);
   if(hasFile(name))
-    return ZenLoad::zCModelMeshLib(name,gothicAssets,1.f);
+    return ZenLoad::zCModelMeshLib(name,vdfs(),1.f);
   std::memcpy(&name[name.size()-3],"MDM",3);
   if(hasFile(name)) {
-    ZenLoad::zCModelMeshLib lib(name,gothicAssets,1.f);
+    ZenLoad::zCModelMeshLib lib(name,vdfs(),1.f);
     std::memcpy(&name[name.size()-3],"MDH",3);
     if(hasFile(name)) {
-      auto data=getFileData(name);
-      if(!data.empty()){
-        ZenLoad::ZenParser parser(data.data(), data.size());
+      std::vector<uint8_t> buf;
+      auto                 view = implFileView(name.c_str(),buf);
+      if(!view.empty() && view.size>0){
+        ZenLoad::ZenParser parser(view.data, view.size);
         lib.loadMDH(parser,1.f);
         }
       }
@@ -734,7 +1179,7 @@ ZenLoad::zCModelMeshLib Resources::loadMDS(std::string &name) {
     }
   std::memcpy(&name[name.size()-3],"MDH",3);
   if(hasFile(name))
-    return ZenLoad::zCModelMeshLib(name,gothicAssets,1.f);
+    return ZenLoad::zCModelMeshLib(name,vdfs(),1.f);
   return ZenLoad::zCModelMeshLib();
   }
 
@@ -747,14 +1192,11 @@ const AttachBinder *Resources::bindMesh(const ProtoMesh &anim, const Skeleton &s
     }
   BindK k = BindK(&s,&anim);
 
-  auto it = inst->bindCache.find(k);
-  if(it!=inst->bindCache.end())
-    return it->second.get();
+  if(auto e=inst->bindCache.find(k,inst->generation,false))
+    return e->val.get();
 
   std::unique_ptr<AttachBinder> ret(new AttachBinder(s,anim));
-  auto p = ret.get();
-  inst->bindCache[k] = std::move(ret);
-  return p;
+  return inst->bindCache.insert(k,std::move(ret),sizeof(AttachBinder),inst->generation,false);
   }
 
 Tempest::VertexBuffer<Resources::Vertex> Resources::sphere(int passCount, float R){
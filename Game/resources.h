@@ -11,9 +11,15 @@
 #include <zenload/zCModelMeshLib.h>
 #include <zenload/zTypes.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <tuple>
 
 #include "graphics/material.h"
+#include "utils/assetindex.h"
+#include "utils/mappedfile.h"
+#include "utils/resourcecache.h"
 #include "world/soundfx.h"
 
 class Gothic;
@@ -59,13 +65,14 @@ class Resources final {
       uint32_t color;
       };
 
+    // skinned vertex, packed by VertexCodec; every field is fetched as unorm8x4 and decoded in shader
     struct VertexA {
-      float    norm[3];
-      float    uv[2];
+      uint32_t norm;       // octahedral, snorm16x2
+      uint16_t uv[2];      // half-float
       uint32_t color/*unused*/;
-      float    pos[4][3];
+      uint16_t pos[4][3];  // half-float, in space of bone
       uint8_t  boneId[4];
-      float    weights[4];
+      uint8_t  weights[4]; // unorm8, sum is 255
       };
 
     struct VertexFsq {
@@ -96,9 +103,14 @@ class Resources final {
     static auto                      loadTextureAnim(const std::string& name) -> std::vector<const Tempest::Texture2d*>;
     static       Tempest::Texture2d  loadTexture(const Tempest::Pixmap& pm);
     static       Material            loadMaterial(const ZenLoad::zCMaterialData& src, bool enableAlphaTest);
+    // decodes textures on worker threads and uploads them; returns estimated gpu memory of uploaded textures
+    static size_t                    preloadTextures(const std::vector<std::string>& names);
+    static size_t                    textureSize(const Tempest::Texture2d& t);
 
     static const AttachBinder*       bindMesh      (const ProtoMesh& anim,const Skeleton& s);
     static const ProtoMesh*          loadMesh      (const std::string& name);
+    // source data of static mesh or of attachment in model library; no caching
+    static bool                      loadPackedMesh(const std::string& name, const std::string& attach, ZenLoad::PackedMesh& out);
     static const PfxEmitterMesh*     loadEmiterMesh(const char*        name);
     static const Skeleton*           loadSkeleton  (const char*        name);
     static const Animation*          loadAnimation (const std::string& name);
@@ -118,15 +130,32 @@ class Resources final {
     template<class V>
     static Tempest::IndexBuffer<V>   ibo(const V* data,size_t sz){ return inst->device.ibo(data,sz); }
 
+    // read-only view into memory-mapped archive, valid for the lifetime of Resources
+    struct FileView {
+      const uint8_t* data = nullptr;
+      size_t         size = 0;
+      bool           empty() const { return data==nullptr; }
+      };
+
+    static FileView                  getFileView(const char*        name);
+    static FileView                  getFileView(const std::string& name);
+
     static std::vector<uint8_t>      getFileData(const char*        name);
     static bool                      getFileData(const char*        name,std::vector<uint8_t>& dat);
     static std::vector<uint8_t>      getFileData(const std::string& name);
 
     static bool                      hasFile(const std::string& fname);
     static VDFS::FileIndex&          vdfsIndex();
+    // hash of names and timestamps of loaded archives; changes, when game data is patched
+    static uint64_t                  vdfsHash();
 
     static const Tempest::VertexBuffer<VertexFsq>& fsqVbo();
 
+    // Asset memory management: world loading starts a new generation of assets. evictUnused releases
+    // textures, meshes and animations, not requested since then; must be called, when previous world is gone.
+    static void                      markUnused();
+    static void                      evictUnused();
+
   private:
     static Resources* inst;
 
@@ -156,13 +185,31 @@ class Resources final {
         }
       };
 
-    using TextureCache = std::unordered_map<std::string,std::unique_ptr<Tempest::Texture2d>>;
+    // eviction budgets, in megabytes
+    enum {
+      TextureBudget   = 512,
+      MeshBudget      = 256,
+      SkeletonBudget  = 16,
+      AnimationBudget = 128,
+      };
+
+    using TextureCache = ResourceCache<std::string,Tempest::Texture2d>;
 
     int64_t               vdfTimestamp(const std::u16string& name);
     void                  detectVdf(std::vector<Archive>& ret, const std::u16string& root);
+    bool                  mapArchive(const std::u16string& name);
+    void                  indexArchive(uint32_t id);
+    bool                  validateIndex() const;
+    static FileView       implGetFileView(const char* name, size_t len);
+    static FileView       implGetFileView(uint64_t hash, const char* name, size_t len);
+    void                  implLoadVdfs(const std::vector<std::u16string>& archives);
+    VDFS::FileIndex&      vdfs();
+    FileView              implFileView(const char* name, std::vector<uint8_t>& fallback);
 
     Tempest::Texture2d*   implLoadTexture(TextureCache& cache, const char* cname);
-    Tempest::Texture2d*   implLoadTexture(TextureCache& cache, std::string &&name, const std::vector<uint8_t> &data);
+    bool                  implDecodeTexture(const std::string& name, Tempest::Pixmap& pm);
+    Tempest::Texture2d*   implUploadTexture(TextureCache& cache, const std::string& name, const Tempest::Pixmap& pm);
+    static void           capDds(std::vector<uint8_t>& dds, uint32_t maxSize);
     ProtoMesh*            implLoadMesh(const std::string &name);
     ProtoMesh*            implDecalMesh(const ZenLoad::zCVobData& vob);
     Skeleton*             implLoadSkeleton(std::string name);
@@ -182,17 +229,13 @@ class Resources final {
     using BindK  = std::tuple<const Skeleton*,const ProtoMesh*>;
     using FontK  = std::pair<const std::string,FontType>;
 
+    // all components of key are combined: many meshes share one skeleton and many decals share one texture
     struct Hash {
-      size_t operator()(const BindK& b) const {
-        return std::uintptr_t(std::get<0>(b));
-        }
-      size_t operator()(const DecalK& b) const {
-        return std::uintptr_t(b.mat.tex);
-        }
-      size_t operator()(const FontK& b) const {
-        std::hash<std::string> h;
-        return h(std::get<0>(b));
-        }
+      size_t operator()(const BindK&  b) const;
+      size_t operator()(const DecalK& b) const;
+      size_t operator()(const FontK&  b) const;
+
+      static size_t combine(size_t h, size_t v);
       };
 
     Tempest::Device&      device;
@@ -200,22 +243,32 @@ class Resources final {
     std::recursive_mutex  sync;
     std::unique_ptr<Dx8::DirectMusic> dxMusic;
     Gothic&               gothic;
-    VDFS::FileIndex       gothicAssets;
-
-    std::vector<uint8_t>  fBuff, ddsBuf;
+    VDFS::FileIndex       gothicAssets;     // filled on vdfsTh; accessed only through vdfs()
+    uint64_t              gothicAssetsHash = 0;
+    std::thread           vdfsTh;
+    std::mutex            vdfsSync;
+    std::atomic_bool      vdfsReady{false};
+
+    std::vector<MappedFile> archiveMaps;
+    AssetIndex              assetIndex;
     Tempest::VertexBuffer<VertexFsq>         fsq;
 
+    uint64_t                                                              generation  = 0;
+    bool                                                                  pinTextures = true;
+    uint32_t                                                              texMaxSize  = 0;
     TextureCache                                                          texCache;
 
-    std::unordered_map<std::string,std::unique_ptr<ProtoMesh>>            aniMeshCache;
+    ResourceCache<std::string,ProtoMesh>                                  aniMeshCache;
     std::unordered_map<DecalK,std::unique_ptr<ProtoMesh>,Hash>            decalMeshCache;
-    std::unordered_map<std::string,std::unique_ptr<Skeleton>>             skeletonCache;
-    std::unordered_map<std::string,std::unique_ptr<Animation>>            animCache;
-    std::unordered_map<BindK,std::unique_ptr<AttachBinder>,Hash>          bindCache;
+    ResourceCache<std::string,Skeleton>                                   skeletonCache;
+    ResourceCache<std::string,Animation>                                  animCache;
+    ResourceCache<BindK,AttachBinder,Hash>                                bindCache;
     std::unordered_map<std::string,std::unique_ptr<PfxEmitterMesh>>       emiMeshCache;
 
     std::unordered_map<std::string,std::unique_ptr<Tempest::SoundEffect>> sndCache;
     std::unordered_map<FontK,std::unique_ptr<GthFont>,Hash>               gothicFnt;
+
+  friend class Headless;
   };
 
 
@@ -228,9 +281,9 @@ inline VertexBufferDecl vertexBufferDecl<Resources::Vertex>() {
 
 template<>
 inline VertexBufferDecl vertexBufferDecl<Resources::VertexA>() {
-  return {Decl::float3,Decl::float2,Decl::color,
-          Decl::float3,Decl::float3,Decl::float3,Decl::float3,
-          Decl::color,Decl::float4};
+  return {Decl::color,Decl::color,Decl::color,
+          Decl::color,Decl::color,Decl::color,Decl::color,Decl::color,Decl::color,
+          Decl::color,Decl::color};
   }
 
 template<>
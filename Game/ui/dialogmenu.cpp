@@ -244,7 +244,7 @@ bool DialogMenu::isActive() const {
   }
 
 bool DialogMenu::onStart(Npc &p, Npc &ot) {
-  choise         = ot.dialogChoises(p,except,state==State::PreStart);
+  ot.dialogChoises(p,except,state==State::PreStart,choise);
   state          = State::Active;
   depth          = 0;
   curentIsPl     = true;
@@ -157,6 +157,10 @@ void InventoryMenu::onWorldChanged() {
   chest  = nullptr;
   }
 
+void InventoryMenu::onAssetsEvicted() {
+  renderer.resetBuckets();
+  }
+
 void InventoryMenu::tick(uint64_t /*dt*/) {
   if(player!=nullptr && player->isDown()) {
     close();
@@ -46,6 +46,7 @@ class InventoryMenu : public Tempest::Widget {
     State isOpen() const;
     bool  isActive() const;
     void  onWorldChanged();
+    void  onAssetsEvicted();
 
     void  tick(uint64_t dt);
     void  draw(Tempest::FrameBuffer& fbo, Tempest::Encoder<Tempest::CommandBuffer>& cmd, uint8_t fId);
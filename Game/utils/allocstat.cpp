@@ -0,0 +1,87 @@
+#include "allocstat.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(OPENGOTHIC_ALLOC_STAT)
+static std::atomic<uint64_t> allocCount{0};
+static std::atomic<uint64_t> allocBytes{0};
+
+static void* implAlloc(size_t sz) {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(sz,std::memory_order_relaxed);
+  if(sz==0)
+    sz = 1;
+  return std::malloc(sz);
+  }
+
+bool AllocStat::isEnabled() {
+  return true;
+  }
+
+uint64_t AllocStat::count() {
+  return allocCount.load(std::memory_order_relaxed);
+  }
+
+uint64_t AllocStat::bytes() {
+  return allocBytes.load(std::memory_order_relaxed);
+  }
+
+void* operator new(size_t sz) {
+  if(auto p = implAlloc(sz))
+    return p;
+  throw std::bad_alloc();
+  }
+
+void* operator new[](size_t sz) {
+  if(auto p = implAlloc(sz))
+    return p;
+  throw std::bad_alloc();
+  }
+
+void* operator new(size_t sz, const std::nothrow_t&) noexcept {
+  return implAlloc(sz);
+  }
+
+void* operator new[](size_t sz, const std::nothrow_t&) noexcept {
+  return implAlloc(sz);
+  }
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+  }
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+  }
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+  }
+
+void operator delete[](void* p, size_t) noexcept {
+  std::free(p);
+  }
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+  }
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+  }
+
+#else
+bool AllocStat::isEnabled() {
+  return false;
+  }
+
+uint64_t AllocStat::count() {
+  return 0;
+  }
+
+uint64_t AllocStat::bytes() {
+  return 0;
+  }
+#endif
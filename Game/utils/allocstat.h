@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// counters of global operator new, for profiling of per-frame heap traffic
+// operator new is replaced only in builds with OPENGOTHIC_ALLOC_STAT
+class AllocStat final {
+  public:
+    static bool     isEnabled();
+    static uint64_t count();
+    static uint64_t bytes();
+  };
@@ -0,0 +1,171 @@
+#include "assetindex.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <cctype>
+#include <cstring>
+
+using namespace Tempest;
+
+static const char indexTag[4] = {'O','G','A','I'};
+
+uint64_t AssetIndex::hash(const char* name) {
+  return hash(name,std::strlen(name));
+  }
+
+uint64_t AssetIndex::hash(const char* name, size_t len) {
+  return hash(0xcbf29ce484222325ull,name,len);
+  }
+
+uint64_t AssetIndex::hash(uint64_t h, const char* name, size_t len) {
+  for(size_t i=0; i<len; ++i)
+    h = (h^uint64_t(std::toupper(uint8_t(name[i]))))*0x100000001b3ull;
+  return h;
+  }
+
+void AssetIndex::clear() {
+  entries.clear();
+  names.clear();
+  table.clear();
+  }
+
+void AssetIndex::add(uint32_t archive, const char* name, size_t len, uint32_t offset, uint32_t size) {
+  Entry e;
+  e.hash    = hash(name,len);
+  e.name    = uint32_t(names.size());
+  e.archive = archive;
+  e.offset  = offset;
+  e.size    = size;
+  for(size_t i=0; i<len; ++i)
+    names.push_back(char(std::toupper(uint8_t(name[i]))));
+  names.push_back('\0');
+  entries.push_back(e);
+  }
+
+void AssetIndex::finalize() {
+  size_t cap = 16;
+  while(cap<entries.size()*2)
+    cap <<= 1;
+  table.assign(cap,0);
+
+  std::vector<Entry> unique;
+  unique.reserve(entries.size());
+  for(auto& e:entries) {
+    size_t at = slot(e.hash);
+    bool   dup = false;
+    while(table[at]!=0) {
+      auto& other = unique[table[at]-1];
+      // colliding names are both kept: find() compares names on hash match
+      if(other.hash==e.hash && std::strcmp(names.data()+other.name,names.data()+e.name)==0) {
+        dup = true;
+        break;
+        }
+      at = (at+1) & (cap-1);
+      }
+    if(dup)
+      continue;
+    unique.push_back(e);
+    table[at] = uint32_t(unique.size());
+    }
+  entries = std::move(unique);
+  }
+
+size_t AssetIndex::slot(uint64_t h) const {
+  // FNV low bits are weak - fold upper half in
+  return size_t(h^(h>>32)) & (table.size()-1);
+  }
+
+bool AssetIndex::isSame(const Entry& e, const char* name, size_t len) const {
+  const char* n = names.data()+e.name;
+  for(size_t i=0; i<len; ++i)
+    if(n[i]!=char(std::toupper(uint8_t(name[i]))))
+      return false;
+  return n[len]=='\0';
+  }
+
+const AssetIndex::Entry* AssetIndex::find(const char* name) const {
+  return find(name,std::strlen(name));
+  }
+
+const AssetIndex::Entry* AssetIndex::find(const char* name, size_t len) const {
+  return find(hash(name,len),name,len);
+  }
+
+const AssetIndex::Entry* AssetIndex::find(uint64_t h, const char* name, size_t len) const {
+  if(table.empty())
+    return nullptr;
+  size_t at = slot(h);
+  while(table[at]!=0) {
+    auto& e = entries[table[at]-1];
+    if(e.hash==h && isSame(e,name,len))
+      return &e;
+    at = (at+1) & (table.size()-1);
+    }
+  return nullptr;
+  }
+
+bool AssetIndex::load(const std::string& file, uint64_t key) {
+  clear();
+  try {
+    RFile    fin(file);
+    char     tag[4] = {};
+    uint32_t ver    = 0;
+    uint64_t fkey   = 0;
+    uint32_t sz[3]  = {};
+    if(fin.read(tag,sizeof(tag))!=sizeof(tag) || std::memcmp(tag,indexTag,sizeof(tag))!=0)
+      return false;
+    if(fin.read(&ver,sizeof(ver))!=sizeof(ver) || ver!=Version)
+      return false;
+    if(fin.read(&fkey,sizeof(fkey))!=sizeof(fkey) || fkey!=key)
+      return false;
+    if(fin.read(sz,sizeof(sz))!=sizeof(sz))
+      return false;
+
+    entries.resize(sz[0]);
+    names  .resize(sz[1]);
+    table  .resize(sz[2]);
+    if(fin.read(entries.data(),entries.size()*sizeof(Entry))!=entries.size()*sizeof(Entry) ||
+       fin.read(&names[0],     names.size())                !=names.size() ||
+       fin.read(table.data(),  table.size()*sizeof(uint32_t))!=table.size()*sizeof(uint32_t)) {
+      clear();
+      return false;
+      }
+
+    // table size must be power of two; references must stay in range
+    bool valid = !table.empty() && (table.size() & (table.size()-1))==0 && !names.empty() && names.back()=='\0';
+    for(auto& e:entries)
+      valid &= (e.name<names.size());
+    for(auto t:table)
+      valid &= (t<=entries.size());
+    if(!valid) {
+      clear();
+      return false;
+      }
+    return true;
+    }
+  catch(...) {
+    clear();
+    return false;
+    }
+  }
+
+bool AssetIndex::save(const std::string& file, uint64_t key) const {
+  try {
+    WFile    fout(file);
+    uint32_t ver   = Version;
+    uint32_t sz[3] = {uint32_t(entries.size()), uint32_t(names.size()), uint32_t(table.size())};
+    fout.write(indexTag,sizeof(indexTag));
+    fout.write(&ver,sizeof(ver));
+    fout.write(&key,sizeof(key));
+    fout.write(sz,sizeof(sz));
+    fout.write(entries.data(),entries.size()*sizeof(Entry));
+    fout.write(names.data(),  names.size());
+    fout.write(table.data(),  table.size()*sizeof(uint32_t));
+    return true;
+    }
+  catch(...) {
+    Log::e("unable to write asset index: \"",file,"\"");
+    return false;
+    }
+  }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Flat, case-insensitive index of archive entries: name -> (archive, offset, size).
+// Open-addressing table over 64-bit name hashes; can be persisted, to skip parsing archive tables on startup.
+class AssetIndex final {
+  public:
+    struct Entry final {
+      uint64_t hash    = 0;
+      uint32_t name    = 0; // offset in name table
+      uint32_t archive = 0;
+      uint32_t offset  = 0;
+      uint32_t size    = 0;
+      };
+
+    static uint64_t hash(const char* name);
+    static uint64_t hash(const char* name, size_t len);
+    // continues hash of a prefix: hash(a+b) == hash(hash(a),b)
+    static uint64_t hash(uint64_t prefix, const char* name, size_t len);
+
+    void         clear();
+    // first added entry wins, same as in VDFS::FileIndex
+    void         add(uint32_t archive, const char* name, size_t len, uint32_t offset, uint32_t size);
+    void         finalize();
+
+    const Entry* find(const char* name) const;
+    const Entry* find(const char* name, size_t len) const;
+    // pre-hashed key; name is compared only on hash match
+    const Entry* find(uint64_t hash, const char* name, size_t len) const;
+    const char*  name(const Entry& e) const   { return names.data()+e.name; }
+    size_t       size() const                 { return entries.size(); }
+
+    const std::vector<Entry>& all() const { return entries; }
+
+    bool         load(const std::string& file, uint64_t key);
+    bool         save(const std::string& file, uint64_t key) const;
+
+  private:
+    enum {
+      Version = 2,
+      };
+
+    size_t       slot(uint64_t hash) const;
+    bool         isSame(const Entry& e, const char* name, size_t len) const;
+
+    std::vector<Entry>    entries;
+    std::string           names;
+    std::vector<uint32_t> table; // entry id + 1; 0 - empty slot
+  };
@@ -0,0 +1,47 @@
+#include "framearena.h"
+
+#include <algorithm>
+
+FrameArena& FrameArena::inst() {
+  static thread_local FrameArena arena;
+  return arena;
+  }
+
+void* FrameArena::alloc(size_t sz, size_t align) {
+  if(live==0)
+    rewind();
+
+  size_t at = (offset+align-1) & ~(align-1);
+  if(at+sz<=blockSz) {
+    offset = at+sz;
+    live++;
+    return block.get()+at;
+    }
+
+  // out of space: serve from a dedicated block, until next rewind
+  std::unique_ptr<uint8_t[]> ext(new uint8_t[sz+align]);
+  auto   ptr = reinterpret_cast<uintptr_t>(ext.get());
+  auto   ret = (ptr+align-1) & ~uintptr_t(align-1);
+  overflowSz += sz+align;
+  overflow.emplace_back(std::move(ext));
+  live++;
+  return reinterpret_cast<void*>(ret);
+  }
+
+void FrameArena::free(void* p) {
+  if(p==nullptr)
+    return;
+  live--;
+  }
+
+void FrameArena::rewind() {
+  offset = 0;
+  if(overflow.empty())
+    return;
+  // grow main block to fit whole previous usage
+  const size_t sz = std::max<size_t>(MinBlockSize,(blockSz+overflowSz)*2);
+  overflow.clear();
+  overflowSz = 0;
+  block.reset(new uint8_t[sz]);
+  blockSz = sz;
+  }
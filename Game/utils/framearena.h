@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Per-thread linear allocator for short-living lists in the game tick.
+// Arena rewinds, once every allocation has been returned; memory blocks are
+// kept and merged, so steady state ticks do not hit the heap at all.
+class FrameArena final {
+  public:
+    static FrameArena& inst();
+
+    void*  alloc(size_t sz, size_t align);
+    void   free (void* p);
+
+    size_t capacity() const { return blockSz; }
+
+  private:
+    FrameArena()=default;
+
+    enum { MinBlockSize = 64*1024 };
+
+    void   rewind();
+
+    std::unique_ptr<uint8_t[]>              block;
+    size_t                                  blockSz = 0;
+    size_t                                  offset  = 0;
+    size_t                                  live    = 0;
+    std::vector<std::unique_ptr<uint8_t[]>> overflow;
+    size_t                                  overflowSz = 0;
+  };
+
+template<class T>
+class FrameAllocator {
+  public:
+    using value_type = T;
+
+    FrameAllocator()=default;
+    template<class U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T*   allocate(size_t n)          { return reinterpret_cast<T*>(FrameArena::inst().alloc(n*sizeof(T),alignof(T))); }
+    void deallocate(T* p, size_t)    { FrameArena::inst().free(p); }
+
+    template<class U>
+    bool operator == (const FrameAllocator<U>&) const { return true;  }
+    template<class U>
+    bool operator != (const FrameAllocator<U>&) const { return false; }
+  };
+
+template<class T>
+using FrameVector = std::vector<T,FrameAllocator<T>>;
@@ -0,0 +1,156 @@
+#include "frameprofiler.h"
+
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+std::atomic<bool>                                 FrameProfiler::enabled{false};
+uint64_t                                          FrameProfiler::epoch = 0;
+std::mutex                                        FrameProfiler::sync;
+std::vector<std::unique_ptr<FrameProfiler::Ring>> FrameProfiler::rings;
+uint64_t                                          FrameProfiler::frames[MaxFrames] = {};
+uint64_t                                          FrameProfiler::framesCount = 0;
+uint64_t                                          FrameProfiler::frameMark   = 0;
+uint32_t                                          FrameProfiler::frameTid    = 0;
+std::vector<FrameProfiler::Entry>                 FrameProfiler::frame;
+std::atomic<uint64_t>                             FrameProfiler::counters[CounterCount] = {};
+uint64_t                                          FrameProfiler::lastCounters[CounterCount] = {};
+
+void FrameProfiler::setEnabled(bool e) {
+  if(e && epoch==0)
+    epoch = timeNs();
+  enabled.store(e,std::memory_order_relaxed);
+  }
+
+uint64_t FrameProfiler::timeNs() {
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+  }
+
+FrameProfiler::Ring& FrameProfiler::ring() {
+  static thread_local Ring* r = nullptr;
+  if(r!=nullptr)
+    return *r;
+  // once per thread; rings are never released, so trace keeps events of finished threads
+  std::lock_guard<std::mutex> guard(sync);
+  rings.emplace_back(new Ring());
+  r     = rings.back().get();
+  r->id = uint32_t(rings.size()-1);
+  return *r;
+  }
+
+uint64_t FrameProfiler::enter() {
+  ring().depth++;
+  return timeNs();
+  }
+
+void FrameProfiler::leave(const char* name, uint64_t begin) {
+  const uint64_t end  = timeNs();
+  Ring&          r    = ring();
+  const uint64_t head = r.head.load(std::memory_order_relaxed);
+
+  r.depth--;
+  Event& e = r.ev[head%MaxEvents];
+  e.name   = name;
+  e.begin  = begin;
+  e.dur    = end-begin;
+  e.depth  = r.depth;
+  r.head.store(head+1,std::memory_order_release);
+  }
+
+void FrameProfiler::frameEnd(uint64_t dt) {
+  frames[framesCount%MaxFrames] = dt;
+  framesCount++;
+
+  for(size_t i=0; i<CounterCount; ++i)
+    lastCounters[i] = counters[i].exchange(0,std::memory_order_relaxed);
+
+  frame.clear();
+  if(!isEnabled())
+    return;
+
+  Ring&          r    = ring();
+  const uint64_t head = r.head.load(std::memory_order_relaxed);
+  frameTid = r.id;
+
+  const uint64_t from = std::max(frameMark,head>MaxEvents ? head-MaxEvents : 0);
+  for(uint64_t i=from; i<head; ++i) {
+    auto& e = r.ev[i%MaxEvents];
+    if(e.depth!=0)
+      continue;
+    auto it = std::find_if(frame.begin(),frame.end(),[&e](const Entry& x){ return x.name==e.name; });
+    if(it==frame.end()) {
+      Entry en;
+      en.name = e.name;
+      frame.push_back(en);
+      it = frame.end()-1;
+      }
+    it->time += e.dur;
+    }
+  frameMark = head;
+  }
+
+double FrameProfiler::percentile(double p) {
+  const size_t cnt = size_t(std::min<uint64_t>(framesCount,MaxFrames));
+  if(cnt==0)
+    return 0;
+  uint64_t tmp[MaxFrames] = {};
+  std::copy(frames,frames+cnt,tmp);
+
+  size_t at = size_t(std::lround(p*double(cnt-1)));
+  at = std::min(at,cnt-1);
+  std::nth_element(tmp,tmp+at,tmp+cnt);
+  return double(tmp[at]);
+  }
+
+auto FrameProfiler::lastFrame() -> const std::vector<Entry>& {
+  return frame;
+  }
+
+void FrameProfiler::saveTrace(std::ostream& out) {
+  std::lock_guard<std::mutex> guard(sync);
+
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for(auto& pr:rings) {
+    auto& r = *pr;
+    if(!first)
+      out << ",";
+    first = false;
+    out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << r.id
+        << ",\"args\":{\"name\":\"";
+    if(r.id==frameTid)
+      out << "main"; else
+      out << "thread " << r.id;
+    out << "\"}}";
+
+    // other threads keep writing: events, that are overwritten meanwhile, may come out inconsistent
+    const uint64_t head = r.head.load(std::memory_order_acquire);
+    const uint64_t from = head>MaxEvents ? head-MaxEvents : 0;
+    for(uint64_t i=from; i<head; ++i) {
+      auto& e = r.ev[i%MaxEvents];
+      if(e.name==nullptr || e.begin<epoch)
+        continue;
+      out << ",\n{\"name\":\"" << e.name << "\","
+          << "\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":" << r.id << ","
+          << "\"ts\":"  << double(e.begin-epoch)/1000.0 << ","
+          << "\"dur\":" << double(e.dur)/1000.0
+          << "}";
+      }
+    }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  }
+
+bool FrameProfiler::saveTrace(const char* file) {
+  std::ofstream f(file);
+  if(!f) {
+    Tempest::Log::e("unable to write frame profile: \"",file,"\"");
+    return false;
+    }
+  saveTrace(f);
+  Tempest::Log::i("frame profile saved: \"",file,"\"");
+  return true;
+  }
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Scoped cpu timers for engine subsystems. Every thread writes into own ring buffer,
+// without locks; rings are only read by the thread that calls frameEnd/saveTrace.
+class FrameProfiler final {
+  public:
+    struct Scope final {
+      explicit Scope(const char* name):name(FrameProfiler::enabled.load(std::memory_order_relaxed) ? name : nullptr) {
+        if(this->name!=nullptr)
+          begin = FrameProfiler::enter();
+        }
+      Scope(const Scope&)=delete;
+      ~Scope() {
+        if(name!=nullptr)
+          FrameProfiler::leave(name,begin);
+        }
+      const char* name  = nullptr;
+      uint64_t    begin = 0;
+      };
+
+    enum Counter : uint8_t {
+      UboUploadBytes  = 0,
+      UboUploadRanges = 1,
+      DrawCalls       = 2,
+      DrawObjects     = 3,
+      CounterCount
+      };
+
+    struct Entry final {
+      const char* name = nullptr;
+      uint64_t    time = 0; // ns
+      };
+
+    static void     setEnabled(bool e);
+    static bool     isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // marks end of frame on calling thread, 'dt' - full frame time in ms
+    static void     frameEnd(uint64_t dt);
+    // frame time percentile over last 'MaxFrames' frames, in ms; p in [0..1]
+    static double   percentile(double p);
+    // top-level scopes of the last frame on the thread, that calls frameEnd
+    static auto     lastFrame() -> const std::vector<Entry>&;
+
+    static void     count(Counter c, uint64_t v) {
+      if(isEnabled())
+        counters[c].fetch_add(v,std::memory_order_relaxed);
+      }
+    // value of counter, accumulated during the last frame
+    static uint64_t lastCount(Counter c) { return lastCounters[c]; }
+
+    // Chrome trace-event json, last 'MaxEvents' scopes of every thread
+    static void     saveTrace(std::ostream& out);
+    static bool     saveTrace(const char* file);
+
+  private:
+    enum {
+      MaxEvents = 1<<14,
+      MaxFrames = 256,
+      };
+
+    struct Event final {
+      const char* name  = nullptr;
+      uint64_t    begin = 0;
+      uint64_t    dur   = 0;
+      uint32_t    depth = 0;
+      };
+
+    struct Ring final {
+      uint32_t              id    = 0;
+      uint32_t              depth = 0;
+      std::atomic<uint64_t> head{0};
+      Event                 ev[MaxEvents];
+      };
+
+    static uint64_t timeNs();
+    static uint64_t enter();
+    static void     leave(const char* name, uint64_t begin);
+    static Ring&    ring();
+
+    static std::atomic<bool>                  enabled;
+    static uint64_t                           epoch;
+
+    static std::mutex                         sync;
+    static std::vector<std::unique_ptr<Ring>> rings;
+
+    static uint64_t                           frames[MaxFrames];
+    static uint64_t                           framesCount;
+    static uint64_t                           frameMark;
+    static uint32_t                           frameTid;
+    static std::vector<Entry>                 frame;
+
+    static std::atomic<uint64_t>              counters[CounterCount];
+    static uint64_t                           lastCounters[CounterCount];
+  };
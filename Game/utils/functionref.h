@@ -0,0 +1,26 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+template<class Fn>
+class FunctionRef;
+
+// non-owning reference to a callable; unlike std::function never allocates
+template<class R, class... Args>
+class FunctionRef<R(Args...)> final {
+  public:
+    template<class F, class = typename std::enable_if<!std::is_same<typename std::decay<F>::type,FunctionRef>::value>::type>
+    FunctionRef(F&& f)
+      :obj(const_cast<void*>(reinterpret_cast<const void*>(std::addressof(f)))),
+       fn([](void* obj, Args... args) -> R {
+         return (*reinterpret_cast<typename std::add_pointer<F>::type>(obj))(std::forward<Args>(args)...);
+         }) {
+      }
+
+    R operator()(Args... args) const { return fn(obj,std::forward<Args>(args)...); }
+
+  private:
+    void* obj = nullptr;
+    R   (*fn)(void*, Args...) = nullptr;
+  };
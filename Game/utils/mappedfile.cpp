@@ -0,0 +1,89 @@
+#include "mappedfile.h"
+
+#include <Tempest/Platform>
+#include <Tempest/TextCodec>
+
+#include <utility>
+
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::u16string& path) {
+#ifdef __WINDOWS__
+  HANDLE file = CreateFileW(reinterpret_cast<const WCHAR*>(path.c_str()),GENERIC_READ,FILE_SHARE_READ,
+                            nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+  if(file==INVALID_HANDLE_VALUE)
+    return;
+  LARGE_INTEGER fsz = {};
+  if(!GetFileSizeEx(file,&fsz) || fsz.QuadPart==0) {
+    CloseHandle(file);
+    return;
+    }
+  HANDLE map = CreateFileMappingW(file,nullptr,PAGE_READONLY,0,0,nullptr);
+  CloseHandle(file);
+  if(map==nullptr)
+    return;
+  void* view = MapViewOfFile(map,FILE_MAP_READ,0,0,0);
+  if(view==nullptr) {
+    CloseHandle(map);
+    return;
+    }
+  ptr  = reinterpret_cast<const uint8_t*>(view);
+  sz   = size_t(fsz.QuadPart);
+  hMap = map;
+#else
+  std::string p  = Tempest::TextCodec::toUtf8(path);
+  int         fd = ::open(p.c_str(),O_RDONLY);
+  if(fd<0)
+    return;
+  struct stat st = {};
+  if(::fstat(fd,&st)!=0 || st.st_size<=0) {
+    ::close(fd);
+    return;
+    }
+  void* view = ::mmap(nullptr,size_t(st.st_size),PROT_READ,MAP_PRIVATE,fd,0);
+  ::close(fd);
+  if(view==MAP_FAILED)
+    return;
+  ptr = reinterpret_cast<const uint8_t*>(view);
+  sz  = size_t(st.st_size);
+#endif
+  }
+
+MappedFile::MappedFile(MappedFile&& other)
+  :ptr(other.ptr), sz(other.sz), hMap(other.hMap) {
+  other.ptr  = nullptr;
+  other.sz   = 0;
+  other.hMap = nullptr;
+  }
+
+MappedFile::~MappedFile() {
+  close();
+  }
+
+MappedFile& MappedFile::operator = (MappedFile&& other) {
+  std::swap(ptr, other.ptr);
+  std::swap(sz,  other.sz);
+  std::swap(hMap,other.hMap);
+  return *this;
+  }
+
+void MappedFile::close() {
+  if(ptr==nullptr)
+    return;
+#ifdef __WINDOWS__
+  UnmapViewOfFile(ptr);
+  CloseHandle(reinterpret_cast<HANDLE>(hMap));
+#else
+  ::munmap(const_cast<uint8_t*>(ptr),sz);
+#endif
+  ptr  = nullptr;
+  sz   = 0;
+  hMap = nullptr;
+  }
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. Views into data() stay valid for the lifetime of the object.
+class MappedFile final {
+  public:
+    MappedFile()=default;
+    explicit MappedFile(const std::u16string& path);
+    MappedFile(MappedFile&& other);
+    MappedFile(const MappedFile&)=delete;
+    ~MappedFile();
+
+    MappedFile& operator = (MappedFile&& other);
+
+    bool           isOpen() const { return ptr!=nullptr; }
+    const uint8_t* data()   const { return ptr; }
+    size_t         size()   const { return sz;  }
+
+  private:
+    void           close();
+
+    const uint8_t* ptr  = nullptr;
+    size_t         sz   = 0;
+    void*          hMap = nullptr;
+  };
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Owning cache with usage tracking: every lookup stamps an entry with current generation.
+// Entries, that were not requested during current generation, can be evicted in LRU order,
+// until cache fits into budget. Pinned entries are held by long-living consumers(ui, fonts) and never evicted.
+template<class K, class T, class H = std::hash<K>>
+class ResourceCache final {
+  public:
+    struct Entry final {
+      std::unique_ptr<T> val;
+      size_t             bytes   = 0;
+      uint64_t           lastUse = 0;
+      bool               pinned  = false;
+      };
+
+    struct Stats final {
+      size_t count    = 0;
+      size_t resident = 0; // entries, requested during current generation
+      size_t bytes    = 0;
+      };
+
+    Entry* find(const K& k, uint64_t gen, bool pin) {
+      auto it = data.find(k);
+      if(it==data.end())
+        return nullptr;
+      it->second.lastUse = gen;
+      it->second.pinned |= pin;
+      return &it->second;
+      }
+
+    T* insert(const K& k, std::unique_ptr<T>&& v, size_t bytes, uint64_t gen, bool pin) {
+      auto& e = data[k];
+      total  -= e.bytes;
+      e.val     = std::move(v);
+      e.bytes   = bytes;
+      e.lastUse = gen;
+      e.pinned |= pin;
+      total  += bytes;
+      return e.val.get();
+      }
+
+    template<class F>
+    void forEach(F f) const {
+      for(auto& i:data)
+        if(i.second.val!=nullptr)
+          f(i.first,*i.second.val);
+      }
+
+    // canEvict(key,value) - external dependencies check; returns number of evicted entries
+    template<class F>
+    size_t evict(uint64_t gen, size_t budget, F canEvict) {
+      if(total<=budget)
+        return 0;
+      std::vector<typename Map::iterator> lru;
+      for(auto it=data.begin(); it!=data.end(); ++it) {
+        auto& e = it->second;
+        if(e.pinned || e.lastUse>=gen || e.val==nullptr)
+          continue;
+        if(canEvict(it->first,*e.val))
+          lru.push_back(it);
+        }
+      std::sort(lru.begin(),lru.end(),[](const typename Map::iterator& a, const typename Map::iterator& b){
+        return a->second.lastUse<b->second.lastUse;
+        });
+
+      size_t cnt = 0;
+      for(auto it:lru) {
+        if(total<=budget)
+          break;
+        total -= it->second.bytes;
+        data.erase(it);
+        ++cnt;
+        }
+      return cnt;
+      }
+
+    Stats stats(uint64_t gen) const {
+      Stats s;
+      s.count = data.size();
+      s.bytes = total;
+      for(auto& i:data)
+        if(i.second.lastUse>=gen)
+          s.resident++;
+      return s;
+      }
+
+  private:
+    using Map = std::unordered_map<K,Entry,H>;
+    Map    data;
+    size_t total = 0;
+  };
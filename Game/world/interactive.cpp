@@ -157,8 +157,8 @@ void Interactive::setVisual(const std::string& body) {
   setAnim(Interactive::Active); // setup default anim
   }
 
-void Interactive::updateAnimation() {
-  animChanged |= visual.updateAnimation(nullptr,world);
+void Interactive::updateAnimation(bool evalPose) {
+  animChanged |= visual.updateAnimation(nullptr,world,evalPose);
   }
 
 void Interactive::tick(uint64_t dt) {
@@ -30,7 +30,7 @@ class Interactive : public Vob {
     void                save(Serialize& fout) const override;
 
     void                resetPositionToTA();
-    void                updateAnimation();
+    void                updateAnimation(bool evalPose=true);
     void                tick(uint64_t dt);
 
     const std::string&  tag() const;
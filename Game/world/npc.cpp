@@ -581,7 +581,7 @@ Vec3 Npc::cameraBone() const {
   auto bone=visual.pose().cameraBone();
   Tempest::Vec3 r={};
   bone.project(r.x,r.y,r.z);
-  visual.position().project(r.x,r.y,r.z);
+  visual.renderPosition().project(r.x,r.y,r.z);
   return r;
   }
 
@@ -651,7 +651,13 @@ int Npc::calcAniComb() const {
   return Pose::calcAniComb(dpos,angle);
   }
 
-void Npc::updateAnimation() {
+void Npc::updateAnimation(bool evalPose) {
+  if(!evalPose) {
+    visual.updateAnimation(this,owner,false);
+    updateTransform();
+    return;
+    }
+
   if(currentTarget!=nullptr)
     visual.setTarget(currentTarget->position()); else
     visual.setTarget(position());
@@ -671,6 +677,15 @@ void Npc::updateTransform() {
     }
   }
 
+void Npc::commitTransform() {
+  updateTransform();
+  visual.commitPosition();
+  }
+
+void Npc::interpolateTransform(float alpha) {
+  visual.interpolatePosition(alpha);
+  }
+
 const char *Npc::displayName() const {
   return hnpc.name[0].c_str();
   }
@@ -3142,8 +3157,8 @@ void Npc::transformBack() {
   transform.reset();
   }
 
-std::vector<GameScript::DlgChoise> Npc::dialogChoises(Npc& player,const std::vector<uint32_t> &except,bool includeImp) {
-  return owner.script().dialogChoises(&player.hnpc,&this->hnpc,except,includeImp);
+void Npc::dialogChoises(Npc& player,const std::vector<uint32_t> &except,bool includeImp,std::vector<GameScript::DlgChoise>& out) {
+  owner.script().dialogChoises(&player.hnpc,&this->hnpc,except,includeImp,out);
   }
 
 bool Npc::isAiQueueEmpty() const {
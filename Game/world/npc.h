@@ -230,8 +230,13 @@ class Npc final {
     float      qDistTo(const Npc& p) const;
     float      qDistTo(const Interactive& p) const;
 
-    void       updateAnimation();
+    // evalPose==false: only events, overlays and effects are processed; skeleton stays as is
+    void       updateAnimation(bool evalPose=true);
     void       updateTransform();
+    // commitTransform: at begin of simulation step; interpolateTransform: per render frame
+    void       commitTransform();
+    void       interpolateTransform(float alpha);
+    uint64_t   animationTime() const { return visual.pose().lastUpdateTime(); }
 
     const char*displayName() const;
     auto       displayPosition() const -> Tempest::Vec3;
@@ -396,7 +401,7 @@ class Npc final {
     void      startDive();
     void      transformBack();
 
-    auto      dialogChoises(Npc &player, const std::vector<uint32_t> &except, bool includeImp) -> std::vector<GameScript::DlgChoise>;
+    void      dialogChoises(Npc &player, const std::vector<uint32_t> &except, bool includeImp, std::vector<GameScript::DlgChoise>& out);
 
     auto      handle() -> Daedalus::GEngineClasses::C_Npc* { return  &hnpc; }
 
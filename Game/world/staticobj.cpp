@@ -15,52 +15,99 @@ StaticObj::StaticObj(Vob* parent, World& world, ZenLoad::zCVobData&& vob, bool s
   if(vob.visual.find("FIREPLACE")==0)
     Log::d("");
 
+  scheme    = vob.visual;
+  hasPhysic = (vob.cdDyn || vob.cdStatic);
+
   if(FileExt::hasExt(vob.visual,"PFX")) {
-    const ParticleFx* view = world.script().getParticleFx(vob.visual.c_str());
-    if(view==nullptr)
-      return;
-    pfx = world.getView(view);
-    pfx.setActive(true);
-    pfx.setLooped(true);
-    pfx.setObjMatrix(transform());
+    stream = StPfx;
     } else
   if(FileExt::hasExt(vob.visual,"TGA")) {
+    // decals and camera-aligned sprites are built from full vob description: not streamed
     if(vob.visualCamAlign==0) {
       auto mesh = world.getDecalView(vob);
-      visual.setVisualBody(std::move(mesh),world);
-      visual.setPos(transform());
+      visual.reset(new MdlVisual());
+      visual->setVisualBody(std::move(mesh),world);
+      visual->setPos(transform());
+      visual->setYTranslationEnable(false);
       } else {
       pfx = world.getView(vob);
       pfx.setActive(true);
       pfx.setLooped(true);
       pfx.setObjMatrix(transform());
       }
+    return;
     } else {
-    auto view = Resources::loadMesh(vob.visual);
-    if(!view)
-      return;
-
-    auto sk   = Resources::loadSkeleton(vob.visual.c_str());
-    auto mesh = world.getStaticView(vob.visual.c_str());
-    visual.setVisual(sk);
-    visual.setVisualBody(std::move(mesh),world);
-
-    if(vob.cdDyn || vob.cdStatic) {
-      physic = PhysicMesh(*view,*world.physic(),false);
-      physic.setObjMatrix(transform());
-      }
-    visual.setPos(transform());
+    stream = StMesh;
+    }
+
+  world.addStatic(this,Vec3(vob.bbox[0].x,vob.bbox[0].y,vob.bbox[0].z),
+                       Vec3(vob.bbox[1].x,vob.bbox[1].y,vob.bbox[1].z));
+  }
+
+void StaticObj::setVisualStreamed(bool active) {
+  if(!active) {
+    pfx = PfxObjects::Emitter();
+    visual.reset();
+    return;
+    }
+  switch(stream) {
+    case StNone:
+      break;
+    case StMesh:
+      mkMesh();
+      break;
+    case StPfx:
+      mkPfx();
+      break;
+    }
+  }
+
+void StaticObj::setPhysicStreamed(bool active) {
+  if(!active) {
+    physic = PhysicMesh();
+    return;
     }
+  if(stream!=StMesh || !hasPhysic)
+    return;
+  auto view = Resources::loadMesh(scheme);
+  if(!view)
+    return;
+  physic = PhysicMesh(*view,*world.physic(),false);
+  physic.setObjMatrix(transform());
+  }
+
+void StaticObj::mkMesh() {
+  auto view = Resources::loadMesh(scheme);
+  if(!view)
+    return;
+
+  auto sk   = Resources::loadSkeleton(scheme.c_str());
+  auto mesh = world.getStaticView(scheme.c_str());
+  visual.reset(new MdlVisual());
+  visual->setVisual(sk);
+  visual->setVisualBody(std::move(mesh),world);
+  visual->setPos(transform());
+  visual->setYTranslationEnable(false);
+  if(!mobAnim.empty())
+    visual->startAnimAndGet(mobAnim.c_str(),world.tickCount());
+  }
 
-  scheme = std::move(vob.visual);
-  visual.setYTranslationEnable(false);
+void StaticObj::mkPfx() {
+  const ParticleFx* view = world.script().getParticleFx(scheme.c_str());
+  if(view==nullptr)
+    return;
+  pfx = world.getView(view);
+  pfx.setActive(true);
+  pfx.setLooped(true);
+  pfx.setObjMatrix(transform());
   }
 
 void StaticObj::moveEvent() {
   Vob::moveEvent();
   pfx   .setObjMatrix(transform());
   physic.setObjMatrix(transform());
-  visual.setPos(transform());
+  if(visual!=nullptr)
+    visual->setPos(transform());
   }
 
 bool StaticObj::setMobState(const char* sc, int32_t st) {
@@ -70,8 +117,13 @@ bool StaticObj::setMobState(const char* sc, int32_t st) {
     return ret;
   char buf[256]={};
   std::snprintf(buf,sizeof(buf),"S_S%d",st);
-  if(visual.startAnimAndGet(buf,world.tickCount())!=nullptr) {
-    // state = st;
+  if(visual==nullptr && stream==StMesh) {
+    // not streamed in: animation is applied on activation
+    mobAnim = buf;
+    return ret;
+    }
+  if(visual!=nullptr && visual->startAnimAndGet(buf,world.tickCount())!=nullptr) {
+    mobAnim = buf;
     return ret;
     }
   return false;
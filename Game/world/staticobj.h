@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "graphics/meshobjects.h"
 #include "graphics/pfxobjects.h"
 #include "graphics/mdlvisual.h"
@@ -10,14 +12,30 @@ class StaticObj : public Vob {
   public:
     StaticObj(Vob* parent, World& world, ZenLoad::zCVobData&& vob, bool startup);
 
+    // called by WorldPartition: visual and pfx are streamed up to render distance,
+    // collision mesh only near the player
+    void  setVisualStreamed(bool active);
+    void  setPhysicStreamed(bool active);
+
   private:
+    enum StreamType : uint8_t {
+      StNone = 0, // nothing to stream: no visual, or resident visual(decals)
+      StMesh = 1,
+      StPfx  = 2,
+      };
+
     void  moveEvent() override;
     bool  setMobState(const char* scheme,int32_t st) override;
 
+    void  mkMesh();
+    void  mkPfx();
+
     PhysicMesh                 physic;
     PfxObjects::Emitter        pfx;
 
-    MdlVisual                  visual;
+    std::unique_ptr<MdlVisual> visual;
     std::string                scheme;
+    std::string                mobAnim;
+    StreamType                 stream    = StNone;
+    bool                       hasPhysic = false;
   };
-
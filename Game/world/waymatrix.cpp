@@ -6,6 +6,7 @@
 
 #include "game/movealgo.h"
 #include "utils/gthfont.h"
+#include "worldcache.h"
 #include "world.h"
 
 using namespace Tempest;
@@ -31,11 +32,18 @@ WayMatrix::WayMatrix(World &world, const ZenLoad::zCWayNetData &dat)
   stk[1].reserve(256);
   }
 
-void WayMatrix::buildIndex() {
+void WayMatrix::buildIndex(WorldCache& cache) {
+  // landRay per point is costly on big worlds - heights are taken from cache, when possible
+  std::vector<float> height(wayPoints.size()+freePoints.size()+startPoints.size());
+  const bool cached = cache.waypoints(height);
+  float*     h      = height.data();
+
   indexPoints.clear();
-  adjustWaypoints(wayPoints);
-  adjustWaypoints(freePoints);
-  adjustWaypoints(startPoints);
+  adjustWaypoints(wayPoints,  h,cached);
+  adjustWaypoints(freePoints, h,cached);
+  adjustWaypoints(startPoints,h,cached);
+  if(!cached)
+    cache.setWaypoints(height);
   std::sort(indexPoints.begin(),indexPoints.end(),[](const WayPoint* a,const WayPoint* b){
     return a->name<b->name;
     });
@@ -162,9 +170,14 @@ void WayMatrix::marchPoints(Tempest::Painter &p, const Tempest::Matrix4x4 &mvp,
     }
   }
 
-void WayMatrix::adjustWaypoints(std::vector<WayPoint> &wp) {
+void WayMatrix::adjustWaypoints(std::vector<WayPoint> &wp, float*& height, bool cached) {
   for(auto& w:wp) {
-    w.y = world.physic()->landRay(w.x,w.y,w.z).v.y;
+    if(cached)
+      w.y = *height;
+    else
+      w.y = world.physic()->landRay(w.x,w.y,w.z).v.y;
+    *height = w.y;
+    ++height;
     indexPoints.push_back(&w);
     }
   }
@@ -11,6 +11,7 @@
 #include "waypoint.h"
 
 class World;
+class WorldCache;
 
 class WayMatrix final {
   public:
@@ -24,7 +25,7 @@ class WayMatrix final {
     void            addStartPoint(const Tempest::Vec3& pos, const Tempest::Vec3& dir, const char* name);
 
     const WayPoint& startPoint() const;
-    void            buildIndex();
+    void            buildIndex(WorldCache& cache);
 
     const WayPoint* findPoint(const char* name, bool inexact) const;
     void            marchPoints(Tempest::Painter& p, const Tempest::Matrix4x4 &mvp, int w, int h) const;
@@ -52,7 +53,7 @@ class WayMatrix final {
     mutable uint16_t                      pathGen=0;
     mutable std::vector<const WayPoint*>  stk[2];
 
-    void                   adjustWaypoints(std::vector<WayPoint> &wp);
+    void                   adjustWaypoints(std::vector<WayPoint> &wp, float*& height, bool cached);
 
     const FpIndex&         findFpIndex(const char* name) const;
     const WayPoint*        findFreePoint(float x, float y, float z, const FpIndex &ind,
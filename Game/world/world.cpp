@@ -3,6 +3,7 @@
 #include <zenload/zCMesh.h>
 #include <fstream>
 #include <functional>
+#include <chrono>
 #include <cctype>
 
 #include <Tempest/Log>
@@ -14,6 +15,7 @@
 #include "world/npc.h"
 #include "world/item.h"
 #include "world/interactive.h"
+#include "world/worldcache.h"
 #include "game/serialize.h"
 #include "gothic.h"
 #include "focus.h"
@@ -35,10 +37,11 @@ World::World(Gothic& gothic, GameSession& game,const RendererStorage &storage, s
   parser.readWorld(world,isG2==2);
 
   ZenLoad::zCMesh* worldMesh = parser.getWorldMesh();
-  PackedMesh vmesh(*worldMesh,PackedMesh::PK_VisualLnd);
+  WorldCache       cache(wname);
+  PackedMesh       vmesh = cache.packedMesh(*worldMesh,PackedMesh::PK_VisualLnd);
 
   loadProgress(50);
-  wdynamic.reset(new DynamicWorld(*this,*worldMesh));
+  wdynamic.reset(new DynamicWorld(*this,cache.packedMesh(*worldMesh,PackedMesh::PK_PhysicZoned)));
   wview.reset   (new WorldView(*this,vmesh,storage));
   loadProgress(70);
 
@@ -47,7 +50,8 @@ World::World(Gothic& gothic, GameSession& game,const RendererStorage &storage, s
     for(auto& vob:world.rootVobs)
       wobj.addRoot(std::move(vob),true);
     }
-  wmatrix->buildIndex();
+  wmatrix->buildIndex(cache);
+  cache.commit();
   bsp = std::move(world.bspTree);
   bspSectors.resize(bsp.sectors.size());
   loadProgress(100);
@@ -68,10 +72,11 @@ World::World(Gothic& gothic, GameSession &game, const RendererStorage &storage,
   parser.readWorld(world,isG2==2);
 
   ZenLoad::zCMesh* worldMesh = parser.getWorldMesh();
-  PackedMesh vmesh(*worldMesh,PackedMesh::PK_VisualLnd);
+  WorldCache       cache(wname);
+  PackedMesh       vmesh = cache.packedMesh(*worldMesh,PackedMesh::PK_VisualLnd);
 
   loadProgress(50);
-  wdynamic.reset(new DynamicWorld(*this,*worldMesh));
+  wdynamic.reset(new DynamicWorld(*this,cache.packedMesh(*worldMesh,PackedMesh::PK_PhysicZoned)));
   wview.reset   (new WorldView(*this,vmesh,storage));
   loadProgress(70);
 
@@ -80,7 +85,8 @@ World::World(Gothic& gothic, GameSession &game, const RendererStorage &storage,
     for(auto& vob:world.rootVobs)
       wobj.addRoot(std::move(vob),false);
     }
-  wmatrix->buildIndex();
+  wmatrix->buildIndex(cache);
+  cache.commit();
   bsp = std::move(world.bspTree);
   bspSectors.resize(bsp.sectors.size());
 
@@ -225,11 +231,11 @@ const ParticleFx* World::loadParticleFx(const char *name) const {
   return game.loadParticleFx(name);
   }
 
-void World::updateAnimation() {
+void World::updateAnimation(float alpha) {
   static bool doAnim=true;
   if(!doAnim)
     return;
-  wobj.updateAnimation();
+  wobj.updateAnimation(alpha);
   }
 
 void World::resetPositionToTA() {
@@ -310,11 +316,23 @@ void World::tick(uint64_t dt) {
   static bool doTicks=true;
   if(!doTicks)
     return;
+  using namespace std::chrono;
+  auto t0 = steady_clock::now();
   wobj.tick(dt);
+  auto t1 = steady_clock::now();
   wdynamic->tick(dt);
+  auto t2 = steady_clock::now();
   wview->tick(dt);
+  auto t3 = steady_clock::now();
   if(auto pl = player())
     wsound.tick(*pl);
+  auto t4 = steady_clock::now();
+
+  tickTm.objects += uint64_t(duration_cast<nanoseconds>(t1-t0).count());
+  tickTm.physics += uint64_t(duration_cast<nanoseconds>(t2-t1).count());
+  tickTm.view    += uint64_t(duration_cast<nanoseconds>(t3-t2).count());
+  tickTm.sound   += uint64_t(duration_cast<nanoseconds>(t4-t3).count());
+  tickTm.ticks   += 1;
   }
 
 uint64_t World::tickCount() const {
@@ -756,6 +774,10 @@ void World::addInteractive(Interactive* inter) {
   wobj.addInteractive(inter);
   }
 
+void World::addStatic(StaticObj* obj, const Vec3& bmin, const Vec3& bmax) {
+  wobj.addStatic(obj,bmin,bmax);
+  }
+
 void World::addStartPoint(const Vec3& pos, const Vec3& dir, const char* name) {
   wmatrix->addStartPoint(pos,dir,name);
   }
@@ -841,15 +863,15 @@ const WayPoint *World::findNextPoint(const WayPoint &pos) const {
   return wmatrix->findNextPoint(pos.x,pos.y,pos.z);
   }
 
-void World::detectNpcNear(std::function<void (Npc &)> f) {
+void World::detectNpcNear(FunctionRef<void(Npc&)> f) {
   wobj.detectNpcNear(f);
   }
 
-void World::detectNpc(const Tempest::Vec3& p, const float r, const std::function<void(Npc&)>& f) {
+void World::detectNpc(const Tempest::Vec3& p, const float r, FunctionRef<void(Npc&)> f) {
   wobj.detectNpc(p.x,p.y,p.z,r,f);
   }
 
-void World::detectItem(const Vec3& p, const float r, const std::function<void(Item&)>& f) {
+void World::detectItem(const Vec3& p, const float r, FunctionRef<void(Item&)> f) {
   wobj.detectItem(p.x,p.y,p.z,r,f);
   }
 
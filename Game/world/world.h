@@ -21,6 +21,7 @@
 #include "waypoint.h"
 #include "waymatrix.h"
 #include "resources.h"
+#include "utils/functionref.h"
 
 class GameSession;
 class RendererStorage;
@@ -29,6 +30,7 @@ class WayMatrix;
 class VisualFx;
 class ParticleFx;
 class Interactive;
+class StaticObj;
 class VersionInfo;
 
 class World final {
@@ -67,9 +69,9 @@ class World final {
     const WayPoint*      findNextFreePoint(const Npc& pos,const char* name) const;
     const WayPoint*      findNextPoint(const WayPoint& pos) const;
 
-    void                 detectNpcNear(std::function<void(Npc&)> f);
-    void                 detectNpc (const Tempest::Vec3& p, const float r, const std::function<void(Npc&)>& f);
-    void                 detectItem(const Tempest::Vec3& p, const float r, const std::function<void(Item&)>& f);
+    void                 detectNpcNear(FunctionRef<void(Npc&)> f);
+    void                 detectNpc (const Tempest::Vec3& p, const float r, FunctionRef<void(Npc&)> f);
+    void                 detectItem(const Tempest::Vec3& p, const float r, FunctionRef<void(Item&)> f);
 
     WayPath              wayTo(const Npc& pos,const WayPoint& end) const;
     WayPath              wayTo(float npcX,float npcY,float npcZ,const WayPoint& end) const;
@@ -103,7 +105,17 @@ class World final {
     const VisualFx*      loadVisualFx(const char* name);
     const ParticleFx*    loadParticleFx(const char* name) const;
 
-    void                 updateAnimation();
+    struct TickTime final {
+      uint64_t objects = 0; // ns, includes npc ai and scripts
+      uint64_t physics = 0;
+      uint64_t view    = 0;
+      uint64_t sound   = 0;
+      uint64_t ticks   = 0;
+      };
+
+    void                 updateAnimation(float alpha);
+    auto                 tickTime() const -> const TickTime& { return tickTm; }
+    auto                 animationStats() const -> const WorldObjects::AnimStats& { return wobj.animationStats(); }
     void                 resetPositionToTA();
 
     auto                 takeHero() -> std::unique_ptr<Npc>;
@@ -168,6 +180,7 @@ class World final {
 
     void                 addTrigger    (AbstractTrigger* trigger);
     void                 addInteractive(Interactive* inter);
+    void                 addStatic     (StaticObj* obj, const Tempest::Vec3& bmin, const Tempest::Vec3& bmax);
     void                 addStartPoint (const Tempest::Vec3& pos, const Tempest::Vec3& dir, const char* name);
     void                 addFreePoint  (const Tempest::Vec3& pos, const Tempest::Vec3& dir, const char* name);
     void                 addSound      (const ZenLoad::zCVobData& vob);
@@ -190,6 +203,7 @@ class World final {
     WorldSound                            wsound;
     WorldObjects                          wobj;
     std::unique_ptr<Npc>                  lvlInspector;
+    TickTime                              tickTm;
 
     auto         roomAt(const ZenLoad::zCBspNode &node) -> const std::string &;
     auto         portalAt(const std::string& tag) -> BspSector*;
@@ -0,0 +1,228 @@
+#include "worldcache.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <chrono>
+#include <cstring>
+
+#include "resources.h"
+
+using namespace Tempest;
+
+static const char cacheTag[4] = {'O','G','W','C'};
+
+WorldCache::WorldCache(const std::string& world)
+  :fname(world+".cache") {
+  key = Resources::vdfsHash();
+  for(auto c:world)
+    key = (key^uint64_t(uint8_t(c)))*0x100000001b3ull;
+  key = (key^uint64_t(sizeof(PackedMesh::WorldVertex)))*0x100000001b3ull;
+
+  try {
+    RFile fin(fname);
+    char     tag[4] = {};
+    uint32_t ver    = 0;
+    uint64_t fkey   = 0;
+    uint32_t count  = 0;
+    if(fin.read(tag,sizeof(tag))!=sizeof(tag) || std::memcmp(tag,cacheTag,sizeof(tag))!=0)
+      return;
+    if(fin.read(&ver,sizeof(ver))!=sizeof(ver) || ver!=Version)
+      return;
+    if(fin.read(&fkey,sizeof(fkey))!=sizeof(fkey) || fkey!=key)
+      return;
+    if(fin.read(&count,sizeof(count))!=sizeof(count))
+      return;
+
+    for(uint32_t i=0; i<count; ++i) {
+      uint32_t id = 0;
+      uint64_t sz = 0;
+      if(fin.read(&id,sizeof(id))!=sizeof(id) || fin.read(&sz,sizeof(sz))!=sizeof(sz) || id>=S_Count)
+        break;
+      auto& d = data[id];
+      d.resize(size_t(sz));
+      if(fin.read(d.data(),d.size())!=d.size()) {
+        d.clear();
+        break;
+        }
+      }
+    }
+  catch(...) {
+    // no cache yet
+    }
+  }
+
+PackedMesh WorldCache::packedMesh(const ZenLoad::zCMesh& mesh, PackedMesh::PkgType type) {
+  Section sec = S_Count;
+  if(type==PackedMesh::PK_VisualLnd)
+    sec = S_VisualLnd;
+  else if(type==PackedMesh::PK_PhysicZoned)
+    sec = S_PhysicZoned;
+  if(sec==S_Count)
+    return PackedMesh(mesh,type);
+
+  PackedMesh ret;
+  if(readMesh(data[sec],mesh,type,ret))
+    return ret;
+
+  // rebuild timing is logged, to keep track of PackedMesh performance on real worlds
+  auto t0 = std::chrono::steady_clock::now();
+  ret = PackedMesh(mesh,type);
+  auto t1 = std::chrono::steady_clock::now();
+  Log::i("world cache: packed ",ret.vertices.size()," vertices, ",ret.subMeshes.size()," submeshes in ",
+         std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count(),"ms");
+
+  data[sec].clear();
+  writeMesh(data[sec],ret);
+  changed = true;
+  return ret;
+  }
+
+bool WorldCache::waypoints(std::vector<float>& heights) const {
+  auto&    d  = data[S_Waypoints];
+  size_t   at = 0;
+  uint32_t sz = 0;
+  if(!read(d,at,&sz,sizeof(sz)) || sz!=heights.size())
+    return false;
+  return read(d,at,heights.data(),sz*sizeof(float));
+  }
+
+void WorldCache::setWaypoints(const std::vector<float>& heights) {
+  auto&    d  = data[S_Waypoints];
+  uint32_t sz = uint32_t(heights.size());
+  d.clear();
+  write(d,&sz,sizeof(sz));
+  write(d,heights.data(),sz*sizeof(float));
+  changed = true;
+  }
+
+void WorldCache::commit() {
+  if(!changed)
+    return;
+  try {
+    WFile    fout(fname);
+    uint32_t ver   = Version;
+    uint32_t count = S_Count;
+    fout.write(cacheTag,sizeof(cacheTag));
+    fout.write(&ver,  sizeof(ver));
+    fout.write(&key,  sizeof(key));
+    fout.write(&count,sizeof(count));
+    for(uint32_t i=0; i<S_Count; ++i) {
+      uint64_t sz = data[i].size();
+      fout.write(&i, sizeof(i));
+      fout.write(&sz,sizeof(sz));
+      fout.write(data[i].data(),data[i].size());
+      }
+    changed = false;
+    }
+  catch(...) {
+    Log::e("unable to write world cache: \"",fname,"\"");
+    }
+  }
+
+void WorldCache::write(std::vector<uint8_t>& out, const void* d, size_t sz) {
+  auto b = reinterpret_cast<const uint8_t*>(d);
+  out.insert(out.end(),b,b+sz);
+  }
+
+bool WorldCache::read(const std::vector<uint8_t>& in, size_t& at, void* d, size_t sz) {
+  if(at+sz>in.size())
+    return false;
+  std::memcpy(d,in.data()+at,sz);
+  at += sz;
+  return true;
+  }
+
+bool WorldCache::fits(const std::vector<uint8_t>& in, size_t at, uint32_t count, size_t eltSize) {
+  // checked before resize: garbage count must not turn into huge allocation
+  return at<=in.size() && uint64_t(count)*eltSize<=in.size()-at;
+  }
+
+void WorldCache::writeMesh(std::vector<uint8_t>& out, const PackedMesh& m) {
+  // vertices and indices are stored as flat arrays, in memory layout of PackedMesh
+  uint32_t vcount = uint32_t(m.vertices.size());
+  uint32_t scount = uint32_t(m.subMeshes.size());
+  write(out,m.bbox,sizeof(m.bbox));
+  write(out,&vcount,sizeof(vcount));
+  write(out,m.vertices.data(),vcount*sizeof(m.vertices[0]));
+  write(out,&scount,sizeof(scount));
+  for(auto& s:m.subMeshes) {
+    uint32_t matIndex = s.matIndex==size_t(-1) ? uint32_t(-1) : uint32_t(s.matIndex);
+    uint8_t  group    = s.material.matGroup;
+    uint32_t nameLen  = uint32_t(s.material.matName.size());
+    uint32_t icount   = uint32_t(s.indices.size());
+    write(out,&matIndex,sizeof(matIndex));
+    write(out,&group,   sizeof(group));
+    write(out,&nameLen, sizeof(nameLen));
+    write(out,s.material.matName.data(),nameLen);
+    write(out,&icount,  sizeof(icount));
+    write(out,s.indices.data(),icount*sizeof(uint32_t));
+
+    uint32_t ccount = uint32_t(s.clusters.size());
+    write(out,&ccount,sizeof(ccount));
+    write(out,s.clusters.data(),ccount*sizeof(PackedMesh::Cluster));
+    }
+  }
+
+bool WorldCache::readMesh(const std::vector<uint8_t>& in, const ZenLoad::zCMesh& mesh,
+                          PackedMesh::PkgType type, PackedMesh& m) {
+  size_t   at     = 0;
+  uint32_t vcount = 0, scount = 0;
+  if(!read(in,at,m.bbox,sizeof(m.bbox)) || !read(in,at,&vcount,sizeof(vcount)))
+    return false;
+  if(!fits(in,at,vcount,sizeof(m.vertices[0])))
+    return false;
+  m.vertices.resize(vcount);
+  if(!read(in,at,m.vertices.data(),vcount*sizeof(m.vertices[0])) || !read(in,at,&scount,sizeof(scount)))
+    return false;
+
+  // smallest record: matIndex, group, nameLen, icount, ccount
+  if(!fits(in,at,scount,sizeof(uint32_t)*4+sizeof(uint8_t)))
+    return false;
+
+  auto& mat = mesh.getMaterials();
+  m.subMeshes.resize(scount);
+  for(auto& s:m.subMeshes) {
+    uint32_t matIndex = 0, nameLen = 0, icount = 0;
+    uint8_t  group    = 0;
+    if(!read(in,at,&matIndex,sizeof(matIndex)) || !read(in,at,&group,sizeof(group)) || !read(in,at,&nameLen,sizeof(nameLen)))
+      return false;
+    if(matIndex!=uint32_t(-1)) {
+      if(matIndex>=mat.size())
+        return false;
+      s.material = mat[matIndex];
+      s.matIndex = matIndex;
+      }
+    s.material.matGroup = group;
+    if(!fits(in,at,nameLen,1))
+      return false;
+    s.material.matName.resize(nameLen);
+    if(nameLen>0 && !read(in,at,&s.material.matName[0],nameLen))
+      return false;
+    if(!read(in,at,&icount,sizeof(icount)) || !fits(in,at,icount,sizeof(uint32_t)))
+      return false;
+    s.indices.resize(icount);
+    if(!read(in,at,s.indices.data(),icount*sizeof(uint32_t)))
+      return false;
+    for(auto i:s.indices)
+      if(i>=vcount)
+        return false;
+
+    uint32_t ccount = 0;
+    if(!read(in,at,&ccount,sizeof(ccount)) || !fits(in,at,ccount,sizeof(PackedMesh::Cluster)))
+      return false;
+    s.clusters.resize(ccount);
+    if(!read(in,at,s.clusters.data(),ccount*sizeof(PackedMesh::Cluster)))
+      return false;
+    for(auto& c:s.clusters)
+      if(c.firstIndex>icount || c.indexCount>icount-c.firstIndex)
+        return false;
+    }
+
+  if(type==PackedMesh::PK_VisualLnd) {
+    for(auto& s:m.subMeshes)
+      if(s.matIndex==size_t(-1))
+        return false;
+    }
+  return true;
+  }
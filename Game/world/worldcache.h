@@ -0,0 +1,47 @@
+#pragma once
+
+#include <zenload/zCMesh.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graphics/mesh/submesh/packedmesh.h"
+
+// Data, derived from zen on every load: packed landscape, physics mesh and waypoint heights.
+// Stored next to save-games and valid only for the same set of game archives.
+class WorldCache final {
+  public:
+    explicit WorldCache(const std::string& world);
+
+    PackedMesh packedMesh(const ZenLoad::zCMesh& mesh, PackedMesh::PkgType type);
+    bool       waypoints   (std::vector<float>& heights) const;
+    void       setWaypoints(const std::vector<float>& heights);
+
+    // writes cache file, if anything has been rebuilt
+    void       commit();
+
+  private:
+    enum Section : uint32_t {
+      S_VisualLnd   = 0,
+      S_PhysicZoned = 1,
+      S_Waypoints   = 2,
+      S_Count
+      };
+
+    enum {
+      Version = 2,
+      };
+
+    std::string          fname;
+    uint64_t             key     = 0;
+    bool                 changed = false;
+    std::vector<uint8_t> data[S_Count];
+
+    static void write(std::vector<uint8_t>& out, const void* d, size_t sz);
+    static bool read (const std::vector<uint8_t>& in, size_t& at, void* d, size_t sz);
+    static bool fits (const std::vector<uint8_t>& in, size_t at, uint32_t count, size_t eltSize);
+
+    static void writeMesh(std::vector<uint8_t>& out, const PackedMesh& m);
+    static bool readMesh (const std::vector<uint8_t>& in, const ZenLoad::zCMesh& mesh, PackedMesh::PkgType type, PackedMesh& m);
+  };
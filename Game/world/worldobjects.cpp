@@ -14,6 +14,7 @@
 #include "world/triggers/messagefilter.h"
 #include "world/interactive.h"
 #include "world/vob.h"
+#include "utils/frameprofiler.h"
 
 #include <Tempest/Painter>
 #include <Tempest/Application>
@@ -22,6 +23,11 @@
 using namespace Tempest;
 using namespace Daedalus::GameState;
 
+static const float nearDist = 3000*3000;
+static const float farDist  = 6000*6000;
+// conservative bounding radius of npc/mob, for visibility tests
+static const float visibleR = 400;
+
 int32_t WorldObjects::MobStates::stateByTime(gtime t) const {
   t = t.timeInDay();
   for(size_t i=routines.size(); i>0; ) {
@@ -69,18 +75,18 @@ void WorldObjects::load(Serialize &fin) {
 
   fin.read(sz);
   npcArr.clear();
+  npcIndex.clear();
   for(size_t i=0;i<sz;++i)
-    npcArr.emplace_back(std::make_unique<Npc>(owner,size_t(-1),nullptr));
+    insertNpc(std::make_unique<Npc>(owner,size_t(-1),nullptr));
   for(auto& i:npcArr)
     i->load(fin);
 
   fin.read(sz);
   itemArr.clear();
-  for(size_t i=0;i<sz;++i){
-    auto it = std::make_unique<Item>(owner,fin,true);
-    itemArr.emplace_back(std::move(it));
-    items.add(itemArr.back().get());
-    }
+  itmIndex.clear();
+  itmHandles.clear();
+  for(size_t i=0;i<sz;++i)
+    insertItem(std::make_unique<Item>(owner,fin,true));
 
   fin.read(sz);
   if(interactiveObj.size()!=sz)
@@ -128,14 +134,24 @@ void WorldObjects::save(Serialize &fout) {
   }
 
 void WorldObjects::tick(uint64_t dt) {
-  auto passive=std::move(sndPerc);
+  FrameProfiler::Scope scope("WorldObjects::tick");
+  // swap buffers instead of move, to keep capacity of both between frames
+  std::swap(sndPerc,sndPercPrev);
   sndPerc.clear();
-
-  std::sort(npcArr.begin(),npcArr.end(),[](std::unique_ptr<Npc>& a, std::unique_ptr<Npc>& b){
-    return a->handle()->id<b->handle()->id;
-    });
-  for(size_t i=0; i<npcArr.size(); ++i)
+  auto& passive = sndPercPrev;
+
+  if(!npcSorted) {
+    std::sort(npcArr.begin(),npcArr.end(),[](std::unique_ptr<Npc>& a, std::unique_ptr<Npc>& b){
+      return a->handle()->id<b->handle()->id;
+      });
+    for(size_t i=0; i<npcArr.size(); ++i)
+      npcIndex[npcArr[i].get()] = uint32_t(i);
+    npcSorted = true;
+    }
+  for(size_t i=0; i<npcArr.size(); ++i) {
+    npcArr[i]->commitTransform();
     npcArr[i]->tick(dt);
+    }
 
   for(auto& i:routines) {
     auto s = i.stateByTime(owner.time());
@@ -169,10 +185,8 @@ void WorldObjects::tick(uint64_t dt) {
     return;
 
   npcNear.clear();
-  const float nearDist = 3000*3000;
-  const float farDist  = 6000*6000;
-
   auto plPos = pl->position();
+  partition.tick(plPos);
   for(auto& i:npcArr) {
     float dist = (i->position()-plPos).quadLength();
     if(dist<nearDist){
@@ -223,17 +237,48 @@ void WorldObjects::tick(uint64_t dt) {
 uint32_t WorldObjects::npcId(const Npc *ptr) const {
   if(ptr==nullptr)
     return uint32_t(-1);
-  for(size_t i=0;i<npcArr.size();++i)
-    if(npcArr[i].get()==ptr)
-      return uint32_t(i);
-  return uint32_t(-1);
+  auto it = npcIndex.find(ptr);
+  if(it==npcIndex.end())
+    return uint32_t(-1);
+  return it->second;
   }
 
 uint32_t WorldObjects::itmId(const void *ptr) const {
-  for(size_t i=0;i<itemArr.size();++i)
-    if(itemArr[i]->handle()==ptr)
-      return uint32_t(i);
-  return uint32_t(-1);
+  if(ptr==nullptr)
+    return uint32_t(-1);
+  auto it = itmHandles.find(ptr);
+  if(it==itmHandles.end())
+    return uint32_t(-1);
+  return itmIndex.find(it->second)->second;
+  }
+
+Npc* WorldObjects::insertNpc(std::unique_ptr<Npc>&& npc) {
+  Npc* ret = npc.get();
+  npcIndex[ret] = uint32_t(npcArr.size());
+  npcArr.emplace_back(std::move(npc));
+  npcSorted = false;
+  return ret;
+  }
+
+std::unique_ptr<Npc> WorldObjects::eraseNpc(size_t id) {
+  auto ret = std::move(npcArr[id]);
+  npcIndex.erase(ret.get());
+  if(id+1!=npcArr.size()) {
+    npcArr[id] = std::move(npcArr.back());
+    npcIndex[npcArr[id].get()] = uint32_t(id);
+    npcSorted = false;
+    }
+  npcArr.pop_back();
+  return ret;
+  }
+
+Item* WorldObjects::insertItem(std::unique_ptr<Item>&& it) {
+  Item* ret = it.get();
+  itmIndex  [ret]           = uint32_t(itemArr.size());
+  itmHandles[ret->handle()] = ret;
+  itemArr.emplace_back(std::move(it));
+  items.add(ret);
+  return ret;
   }
 
 Npc *WorldObjects::addNpc(size_t npcInstance, const Daedalus::ZString& at) {
@@ -255,7 +300,7 @@ Npc *WorldObjects::addNpc(size_t npcInstance, const Daedalus::ZString& at) {
     npc->updateTransform();
     }
 
-  npcArr.emplace_back(npc);
+  insertNpc(std::unique_ptr<Npc>(npc));
   return npc;
   }
 
@@ -265,7 +310,7 @@ Npc* WorldObjects::addNpc(size_t npcInstance, const Vec3& pos) {
   //npc->setDirection (pos->dirX,pos->dirY,pos->dirZ);
   npc->updateTransform();
 
-  npcArr.emplace_back(npc);
+  insertNpc(std::unique_ptr<Npc>(npc));
   return npc;
   }
 
@@ -287,21 +332,14 @@ Npc* WorldObjects::insertPlayer(std::unique_ptr<Npc> &&npc, const Daedalus::ZStr
     npc->attachToPoint(pos);
     npc->updateTransform();
     }
-  npcArr.emplace_back(std::move(npc));
-  return npcArr.back().get();
+  return insertNpc(std::move(npc));
   }
 
 std::unique_ptr<Npc> WorldObjects::takeNpc(const Npc* ptr) {
-  for(size_t i=0; i<npcArr.size(); ++i){
-    auto& npc=*npcArr[i];
-    if(&npc==ptr){
-      auto ret=std::move(npcArr[i]);
-      npcArr[i] = std::move(npcArr.back());
-      npcArr.pop_back();
-      return ret;
-      }
-    }
-  return nullptr;
+  auto it = npcIndex.find(ptr);
+  if(it==npcIndex.end())
+    return nullptr;
+  return eraseNpc(it->second);
   }
 
 void WorldObjects::tickNear(uint64_t /*dt*/) {
@@ -344,13 +382,63 @@ void WorldObjects::execTriggerEvent(const TriggerEvent& e) {
     Log::d("unable to process trigger: \"",e.target,"\"");
   }
 
-void WorldObjects::updateAnimation() {
-  Workers::parallelFor(npcArr,[](std::unique_ptr<Npc>& i){
+void WorldObjects::updateAnimation(float alpha) {
+  // minimal time between pose evaluations, per AnimLod
+  static const uint64_t interval[AnimLodCount] = {0, 66, 200, uint64_t(-1)};
+
+  const uint64_t  now = owner.tickCount();
+  const Frustrum* fr  = owner.view()!=nullptr ? &owner.view()->frustrum() : nullptr;
+
+  std::atomic<uint32_t> evaluated[AnimLodCount] = {};
+  std::atomic<uint32_t> skipped{0};
+
+  Workers::parallelFor(npcArr,[&](std::unique_ptr<Npc>& i){
+    const AnimLod lod = animLod(*i,fr);
+    const uint64_t last = i->animationTime();
+    if(lod==AnimFrozen || (last!=0 && now<last+interval[lod])) {
+      i->updateAnimation(false);
+      i->interpolateTransform(alpha);
+      skipped.fetch_add(1,std::memory_order_relaxed);
+      return;
+      }
     i->updateAnimation();
+    i->interpolateTransform(alpha);
+    evaluated[lod].fetch_add(1,std::memory_order_relaxed);
     });
-  interactiveObj.parallelFor([](Interactive& i){
+
+  const auto pl = owner.player();
+  interactiveObj.parallelFor([&](Interactive& i){
+    if(pl!=nullptr && fr!=nullptr) {
+      auto pos = i.position();
+      if((pos-pl->position()).quadLength()>nearDist && !fr->testPoint(pos.x,pos.y,pos.z,visibleR)) {
+        i.updateAnimation(false);
+        skipped.fetch_add(1,std::memory_order_relaxed);
+        return;
+        }
+      }
     i.updateAnimation();
+    evaluated[AnimFull].fetch_add(1,std::memory_order_relaxed);
     });
+
+  for(size_t i=0; i<AnimLodCount; ++i)
+    animStats.evaluated[i] = evaluated[i].load();
+  animStats.skipped = skipped.load();
+  }
+
+WorldObjects::AnimLod WorldObjects::animLod(const Npc& npc, const Frustrum* fr) {
+  const auto pos     = npc.position();
+  const bool visible = fr==nullptr || fr->testPoint(pos.x,pos.y,pos.z,visibleR);
+  switch(npc.processPolicy()) {
+    case Npc::ProcessPolicy::Player:
+      return AnimFull;
+    case Npc::ProcessPolicy::AiNormal:
+      return visible ? AnimFull    : AnimReduced;
+    case Npc::ProcessPolicy::AiFar:
+      return visible ? AnimReduced : AnimFar;
+    case Npc::ProcessPolicy::AiFar2:
+      return visible ? AnimFar     : AnimFrozen;
+    }
+  return AnimFull;
   }
 
 bool WorldObjects::isTargeted(Npc& dst) {
@@ -387,13 +475,13 @@ Npc *WorldObjects::findNpcByInstance(size_t instance) {
   return nullptr;
   }
 
-void WorldObjects::detectNpcNear(const std::function<void(Npc&)>& f) {
+void WorldObjects::detectNpcNear(FunctionRef<void(Npc&)> f) {
   for(auto& i:npcNear)
     f(*i);
   }
 
 void WorldObjects::detectNpc(const float x, const float y, const float z,
-                             const float r, const std::function<void(Npc&)>& f) {
+                             const float r, FunctionRef<void(Npc&)> f) {
   float maxDist=r*r;
   for(auto& i:npcArr) {
     auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
@@ -403,7 +491,7 @@ void WorldObjects::detectNpc(const float x, const float y, const float z,
   }
 
 void WorldObjects::detectItem(const float x, const float y, const float z,
-                              const float r, const std::function<void(Item&)>& f) {
+                              const float r, FunctionRef<void(Item&)> f) {
   float maxDist=r*r;
   for(auto& i:itemArr) {
     auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
@@ -459,16 +547,22 @@ Item* WorldObjects::addItem(const ZenLoad::zCVobData &vob) {
   }
 
 Item *WorldObjects::takeItem(Item &it) {
-  for(auto& i:itemArr)
-    if(i.get()==&it){
-      auto ret=i.release();
-      i = std::move(itemArr.back());
-      itemArr.pop_back();
-      items.del(ret);
-      ret->setPhysicsDisable();
-      return ret;
-      }
-  return nullptr;
+  auto i = itmIndex.find(&it);
+  if(i==itmIndex.end())
+    return nullptr;
+
+  const uint32_t id  = i->second;
+  auto           ret = itemArr[id].release();
+  itmIndex.erase(i);
+  itmHandles.erase(ret->handle());
+  if(id+1!=itemArr.size()) {
+    itemArr[id] = std::move(itemArr.back());
+    itmIndex[itemArr[id].get()] = id;
+    }
+  itemArr.pop_back();
+  items.del(ret);
+  ret->setPhysicsDisable();
+  return ret;
   }
 
 void WorldObjects::removeItem(Item &it) {
@@ -505,9 +599,7 @@ Item *WorldObjects::addItem(size_t itemInstance, const char *at) {
   auto  pos = owner.findPoint(at);
 
   std::unique_ptr<Item> ptr{new Item(owner,itemInstance)};
-  auto* it=ptr.get();
-  itemArr.emplace_back(std::move(ptr));
-  items.add(itemArr.back().get());
+  auto* it=insertItem(std::move(ptr));
 
   if(pos!=nullptr) {
     it->setPosition (pos->x,pos->y,pos->z);
@@ -525,8 +617,9 @@ void WorldObjects::addInteractive(Interactive* obj) {
   interactiveObj.add(obj);
   }
 
-void WorldObjects::addStatic(StaticObj* obj) {
+void WorldObjects::addStatic(StaticObj* obj, const Tempest::Vec3& bmin, const Tempest::Vec3& bmax) {
   objStatic.push_back(obj);
+  partition.insert(*obj,bmin,bmax);
   }
 
 void WorldObjects::addRoot(ZenLoad::zCVobData&& vob, bool startup) {
@@ -543,14 +636,11 @@ Interactive* WorldObjects::validateInteractive(Interactive *def) {
   }
 
 Npc *WorldObjects::validateNpc(Npc *def) {
-  for(auto& i:npcArr)
-    if(i.get()==def)
-      return def;
-  return nullptr;
+  return npcIndex.find(def)!=npcIndex.end() ? def : nullptr;
   }
 
 Item *WorldObjects::validateItem(Item *def) {
-  return items.hasObject(def) ? def : nullptr;
+  return itmIndex.find(def)!=itmIndex.end() ? def : nullptr;
   }
 
 Interactive* WorldObjects::findInteractive(const Npc &pl, Interactive* def, const SearchOpt& opt) {
@@ -706,8 +796,7 @@ void WorldObjects::resetPositionToTA() {
     if(n.resetPositionToTA()){
       ++i;
       } else {
-      npcInvalid.emplace_back(std::move(npcArr[i]));
-      npcArr.erase(npcArr.begin()+int(i));
+      npcInvalid.emplace_back(eraseNpc(i));
 
       auto& npc = *npcInvalid.back();
       npc.attachToPoint(nullptr);
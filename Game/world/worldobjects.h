@@ -2,14 +2,17 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 #include <daedalus/DaedalusGameState.h>
 
 #include "bullet.h"
 #include "spaceindex.h"
+#include "worldpartition.h"
 #include "game/gametime.h"
 #include "game/perceptionmsg.h"
 #include "game/constants.h"
+#include "utils/functionref.h"
 
 class Npc;
 class Item;
@@ -20,6 +23,7 @@ class World;
 class Serialize;
 class TriggerEvent;
 class AbstractTrigger;
+class Frustrum;
 
 class WorldObjects final {
   public:
@@ -34,6 +38,19 @@ class WorldObjects final {
       FcOverride=8,
       };
 
+    enum AnimLod : uint8_t {
+      AnimFull    = 0,
+      AnimReduced = 1,
+      AnimFar     = 2,
+      AnimFrozen  = 3,
+      AnimLodCount
+      };
+
+    struct AnimStats final {
+      uint32_t evaluated[AnimLodCount] = {};
+      uint32_t skipped                 = 0;
+      };
+
     struct SearchOpt final {
       SearchOpt()=default;
       SearchOpt(float rangeMin, float rangeMax, float azi, TargetCollect collectAlgo=TARGET_COLLECT_CASTER, SearchFlg flags=NoFlg);
@@ -56,7 +73,8 @@ class WorldObjects final {
     Npc*           insertPlayer(std::unique_ptr<Npc>&& npc, const Daedalus::ZString& waypoint);
     auto           takeNpc(const Npc* npc) -> std::unique_ptr<Npc>;
 
-    void           updateAnimation();
+    void           updateAnimation(float alpha);
+    auto           animationStats() const -> const AnimStats& { return animStats; }
 
     bool           isTargeted(Npc& npc);
     Npc*           findHero();
@@ -64,9 +82,9 @@ class WorldObjects final {
     size_t         npcCount()    const { return npcArr.size(); }
     const Npc&     npc(size_t i) const { return *npcArr[i];    }
     Npc&           npc(size_t i)       { return *npcArr[i];    }
-    void           detectNpcNear(const std::function<void(Npc&)>& f);
-    void           detectNpc (const float x, const float y, const float z, const float r, const std::function<void(Npc&)>&  f);
-    void           detectItem(const float x, const float y, const float z, const float r, const std::function<void(Item&)>& f);
+    void           detectNpcNear(FunctionRef<void(Npc&)> f);
+    void           detectNpc (const float x, const float y, const float z, const float r, FunctionRef<void(Npc&)>  f);
+    void           detectItem(const float x, const float y, const float z, const float r, FunctionRef<void(Item&)> f);
 
     size_t         itmCount()    const { return itemArr.size(); }
     Item&          itm(size_t i)       { return *itemArr[i];    }
@@ -88,7 +106,7 @@ class WorldObjects final {
     Bullet&        shootBullet(const Item &itmId, float x, float y, float z, float dx, float dy, float dz, float speed);
 
     void           addInteractive(Interactive*         obj);
-    void           addStatic     (StaticObj*           obj);
+    void           addStatic     (StaticObj*           obj, const Tempest::Vec3& bmin, const Tempest::Vec3& bmax);
     void           addRoot       (ZenLoad::zCVobData&& vob, bool startup);
     void           invalidateVobIndex();
 
@@ -130,6 +148,7 @@ class WorldObjects final {
       };
 
     World&                             owner;
+    WorldPartition                     partition; // must outlive rootVobs
     std::vector<std::unique_ptr<Vob>>  rootVobs;
 
     SpaceIndex<Interactive>            interactiveObj;
@@ -145,12 +164,20 @@ class WorldObjects final {
     std::vector<std::unique_ptr<Npc>>  npcArr;
     std::vector<std::unique_ptr<Npc>>  npcInvalid;
     std::vector<Npc*>                  npcNear;
+    bool                               npcSorted = true;
+
+    // object -> position in npcArr/itemArr; ids are used by save-game and script-bindings
+    std::unordered_map<const Npc*, uint32_t>    npcIndex;
+    std::unordered_map<const Item*,uint32_t>    itmIndex;
+    std::unordered_map<const void*,const Item*> itmHandles;
 
     std::vector<AbstractTrigger*>      triggers;
     std::vector<AbstractTrigger*>      triggersZn;
     std::vector<AbstractTrigger*>      triggersTk;
 
-    std::vector<PerceptionMsg>         sndPerc;
+    AnimStats                          animStats;
+
+    std::vector<PerceptionMsg>         sndPerc, sndPercPrev;
     std::vector<TriggerEvent>          triggerEvents;
 
     template<class T>
@@ -163,7 +190,12 @@ class WorldObjects final {
 
     void             setMobState(const char* scheme, int32_t st);
 
+    Npc*             insertNpc (std::unique_ptr<Npc>&& npc);
+    auto             eraseNpc  (size_t id) -> std::unique_ptr<Npc>;
+    Item*            insertItem(std::unique_ptr<Item>&& it);
+
     void             tickNear(uint64_t dt);
     void             tickTriggers(uint64_t dt);
     static bool      isTargetedBy(Npc& npc,Npc& by);
+    static AnimLod   animLod(const Npc& npc, const Frustrum* fr);
   };
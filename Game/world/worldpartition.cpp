@@ -0,0 +1,107 @@
+#include "worldpartition.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "utils/frameprofiler.h"
+#include "staticobj.h"
+
+using namespace Tempest;
+
+uint64_t WorldPartition::cellKey(int x, int z) {
+  return (uint64_t(uint32_t(x))<<32) | uint64_t(uint32_t(z));
+  }
+
+float WorldPartition::distance(const Cell& c, const Vec3& pos) {
+  float dx = std::max(0.f,std::max(c.bbox[0].x-pos.x,pos.x-c.bbox[1].x));
+  float dy = std::max(0.f,std::max(c.bbox[0].y-pos.y,pos.y-c.bbox[1].y));
+  float dz = std::max(0.f,std::max(c.bbox[0].z-pos.z,pos.z-c.bbox[1].z));
+  return std::sqrt(dx*dx+dy*dy+dz*dz);
+  }
+
+void WorldPartition::insert(StaticObj& obj, const Vec3& bmin, const Vec3& bmax) {
+  // cell is choosen by center; cell bounds are extended by object bounds, so big meshes come in earlier
+  const Vec3 mid = (bmin+bmax)*0.5f;
+  const int  x   = int(std::floor(mid.x/CellSize));
+  const int  z   = int(std::floor(mid.z/CellSize));
+  const auto key = cellKey(x,z);
+
+  auto it = index.find(key);
+  if(it==index.end()) {
+    Cell c;
+    c.bbox[0] = bmin;
+    c.bbox[1] = bmax;
+    cells.emplace_back(std::move(c));
+    it = index.emplace(key,cells.size()-1).first;
+    }
+
+  auto& c = cells[it->second];
+  c.bbox[0] = Vec3(std::min(c.bbox[0].x,bmin.x),std::min(c.bbox[0].y,bmin.y),std::min(c.bbox[0].z,bmin.z));
+  c.bbox[1] = Vec3(std::max(c.bbox[1].x,bmax.x),std::max(c.bbox[1].y,bmax.y),std::max(c.bbox[1].z,bmax.z));
+  c.obj.push_back(&obj);
+  totalCnt++;
+  }
+
+void WorldPartition::setStreamed(StaticObj& obj, Level lv, bool active) {
+  if(lv==LvVisual)
+    obj.setVisualStreamed(active); else
+    obj.setPhysicStreamed(active);
+  }
+
+void WorldPartition::deactivate(Cell& c, Level lv) {
+  auto& s = c.lv[lv];
+  for(size_t i=0; i<s.activated; ++i)
+    setStreamed(*c.obj[i],lv,false);
+  activeCnt[lv] -= s.activated;
+  s.activated    = 0;
+  s.active       = false;
+  }
+
+void WorldPartition::tick(const Vec3& pos) {
+  using namespace std::chrono;
+  FrameProfiler::Scope scope("WorldPartition::tick");
+
+  const bool sync = first || (pos-lastPos).quadLength()>float(TeleportDist)*float(TeleportDist);
+  first   = false;
+  lastPos = pos;
+
+  static const float activateDist[LvCount] = {float(VisualDist), float(PhysicDist)};
+
+  pending.clear();
+  for(size_t i=0; i<cells.size(); ++i) {
+    auto& c = cells[i];
+    float d = distance(c,pos);
+    for(uint8_t l=0; l<LvCount; ++l) {
+      const Level lv = Level(l);
+      auto&       s  = c.lv[lv];
+      if(s.active && d>activateDist[lv]+Hysteresis) {
+        deactivate(c,lv);
+        continue;
+        }
+      if(!s.active && d<activateDist[lv])
+        s.active = true;
+      if(s.active && s.activated<c.obj.size())
+        pending.push_back({d,i,lv});
+      }
+    }
+
+  if(pending.empty())
+    return;
+  std::sort(pending.begin(),pending.end());
+
+  // nearest cells first, physics before visual of same cell;
+  // after teleport or load everything in range is activated at once
+  const auto t0 = steady_clock::now();
+  for(auto& p:pending) {
+    auto& c = cells[p.cell];
+    auto& s = c.lv[p.lv];
+    while(s.activated<c.obj.size()) {
+      setStreamed(*c.obj[s.activated],p.lv,true);
+      s.activated++;
+      activeCnt[p.lv]++;
+      if(!sync && duration_cast<microseconds>(steady_clock::now()-t0).count()>TimeBudgetUs)
+        return;
+      }
+    }
+  }
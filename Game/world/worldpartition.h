@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Tempest/Vec>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class StaticObj;
+
+// Grid of static vobs over XZ plane. Objects of far cells keep only a short description
+// of own visual; meshes and particles are created within render distance,
+// physics only once player comes close.
+class WorldPartition final {
+  public:
+    WorldPartition()=default;
+    WorldPartition(const WorldPartition&)=delete;
+
+    enum Level : uint8_t {
+      LvVisual = 0,
+      LvPhysic = 1,
+      LvCount
+      };
+
+    void   insert(StaticObj& obj, const Tempest::Vec3& bmin, const Tempest::Vec3& bmax);
+    void   tick(const Tempest::Vec3& pos);
+
+    size_t activeCount(Level lv) const { return activeCnt[lv]; }
+    size_t totalCount()          const { return totalCnt;      }
+
+  private:
+    enum {
+      CellSize       = 4000,   // 40 meters
+      VisualDist     = 112000, // far plane of WorldView: 100/0.0009 (Camera::mkView scale)
+      PhysicDist     = 8000,
+      Hysteresis     = 2000,   // to not trash cells on the border
+      TeleportDist   = 4000,   // camera jump, that makes activation synchronous
+      TimeBudgetUs   = 2000,   // activation time per tick
+      };
+
+    struct Slot final {
+      size_t                  activated = 0; // obj[0..activated) are streamed in
+      bool                    active    = false;
+      };
+
+    struct Cell final {
+      Tempest::Vec3           bbox[2];
+      std::vector<StaticObj*> obj;
+      Slot                    lv[LvCount];
+      };
+
+    struct Pending final {
+      float  dist;
+      size_t cell;
+      Level  lv;
+      bool operator < (const Pending& p) const { return dist<p.dist || (dist==p.dist && lv>p.lv); }
+      };
+
+    static uint64_t cellKey(int x, int z);
+    static float    distance(const Cell& c, const Tempest::Vec3& pos);
+    static void     setStreamed(StaticObj& obj, Level lv, bool active);
+    void            deactivate(Cell& c, Level lv);
+
+    std::unordered_map<uint64_t,size_t>  index;
+    std::vector<Cell>                    cells;
+    std::vector<Pending>                 pending;
+
+    Tempest::Vec3                        lastPos;
+    bool                                 first     = true;
+    size_t                               activeCnt[LvCount] = {};
+    size_t                               totalCnt  = 0;
+  };
@@ -2,6 +2,8 @@
 
 #include <Tempest/SoundEffect>
 
+#include <cmath>
+
 #include "game/gamesession.h"
 #include "world/npc.h"
 #include "gamemusic.h"
@@ -39,6 +41,7 @@ void WorldSound::addZone(const ZenLoad::zCVobData &vob) {
   z.name    = vob.vobName;
 
   zones.emplace_back(std::move(z));
+  zoneIndexValid = false;
   }
 
 void WorldSound::addSound(const ZenLoad::zCVobData &vob) {
@@ -61,6 +64,7 @@ void WorldSound::addSound(const ZenLoad::zCVobData &vob) {
   s.active   = pr.sndStartOn;
   s.delay    = uint64_t(pr.sndRandDelay*1000);
   s.delayVar = uint64_t(pr.sndRandDelayVar*1000);
+  s.radius   = pr.sndRadius;
 
   if(vob.vobType==ZenLoad::zCVobData::VT_zCVobSoundDaytime) {
     float b = vob.zCVobSoundDaytime.sndStartTime;
@@ -99,6 +103,8 @@ void WorldSound::emitSound(const char* s, float x, float y, float z, float range
     GSoundEffect eff = game.loadSound(*snd);
     if(eff.isEmpty())
       return;
+    if(slot==nullptr && !allocVoice({x,y,z},range,PrioEffect))
+      return;
     eff.setPosition(x,y,z);
     eff.setMaxDistance(maxDist);
     eff.setRefDistance(range);
@@ -106,7 +112,7 @@ void WorldSound::emitSound(const char* s, float x, float y, float z, float range
     tickSlot(eff);
     if(slot)
       *slot = std::move(eff); else
-      effect.emplace_back(std::move(eff));
+      effect.emplace_back(std::move(eff),range,PrioEffect);
     }
   }
 
@@ -114,20 +120,23 @@ void WorldSound::emitSound3d(const char* s, float x, float y, float z, float ran
   if(range<=0.f)
     range = 3500.f;
 
+  std::lock_guard<std::mutex> guard(sync);
   auto snd = game.loadSoundFx(s);
   if(snd==nullptr)
     return;
   GSoundEffect eff = game.loadSound(*snd);
   if(eff.isEmpty())
     return;
+  // steal a voice only for a sound, that is actually going to play
+  if(!allocVoice({x,y,z},range,PrioEffect))
+    return;
   eff.setPosition(x,y,z);
   eff.setMaxDistance(maxDist);
   eff.setRefDistance(range);
   eff.play();
 
-  std::lock_guard<std::mutex> guard(sync);
   tickSlot(eff);
-  effect3d.emplace_back(std::move(eff));
+  effect.emplace_back(std::move(eff),range,PrioEffect);
   }
 
 void WorldSound::emitSoundRaw(const char *s, float x, float y, float z, float range, bool fSlot) {
@@ -147,6 +156,8 @@ void WorldSound::emitSoundRaw(const char *s, float x, float y, float z, float ra
     GSoundEffect eff = game.loadSound(*snd);
     if(eff.isEmpty())
       return;
+    if(slot==nullptr && !allocVoice({x,y,z},range,PrioEffect))
+      return;
     eff.setPosition(x,y,z);
     eff.setMaxDistance(maxDist);
     eff.setRefDistance(range);
@@ -154,7 +165,7 @@ void WorldSound::emitSoundRaw(const char *s, float x, float y, float z, float ra
     tickSlot(eff);
     if(slot)
       *slot = std::move(eff); else
-      effect.emplace_back(std::move(eff));
+      effect.emplace_back(std::move(eff),range,PrioEffect);
     }
   }
 
@@ -167,19 +178,22 @@ void WorldSound::emitDlgSound(const char *s, float x, float y, float z, float ra
     Tempest::SoundEffect eff = game.loadSound(snd);
     if(eff.isEmpty())
       return;
+    if(!allocVoice({x,y,z},range,PrioDialog))
+      return;
     eff.setPosition(x,y+180,z);
     eff.setMaxDistance(maxDist);
     eff.setRefDistance(range);
     eff.play();
     timeLen = eff.timeLength();
-    effect.emplace_back(std::move(eff));
+    effect.emplace_back(GSoundEffect(std::move(eff)),range,PrioDialog);
     }
   }
 
 void WorldSound::takeSoundSlot(GSoundEffect &&eff) {
   if(eff.isFinished())
     return;
-  effect.emplace_back(std::move(eff));
+  std::lock_guard<std::mutex> guard(sync);
+  effect.emplace_back(std::move(eff),0.f,PrioEffect);
   }
 
 void WorldSound::tick(Npc &player) {
@@ -187,23 +201,23 @@ void WorldSound::tick(Npc &player) {
   plPos = player.position();
 
   game.updateListenerPos(player);
+  occRays = 0;
+
+  if(occNextSweep<owner.tickCount()) {
+    occNextSweep = owner.tickCount()+5*OcclusionTtl;
+    for(auto i=occCache.begin(); i!=occCache.end();) {
+      if(i->second.time+OcclusionTtl<owner.tickCount())
+        i = occCache.erase(i); else
+        ++i;
+      }
+    }
 
   for(size_t i=0;i<effect.size();) {
-    if(effect[i].isFinished()){
+    if(effect[i].eff.isFinished()){
       effect[i]=std::move(effect.back());
       effect.pop_back();
       } else {
-      tickSlot(effect[i]);
-      ++i;
-      }
-    }
-
-  for(size_t i=0;i<effect3d.size();) {
-    if(effect3d[i].isFinished()){
-      effect3d[i]=std::move(effect3d.back());
-      effect3d.pop_back();
-      } else {
-      tickSlot(effect3d[i]);
+      tickSlot(effect[i].eff);
       ++i;
       }
     }
@@ -214,7 +228,8 @@ void WorldSound::tick(Npc &player) {
 
   for(auto& i:worldEff) {
     if(i.active && i.eff.isFinished() && (i.restartTimeout<owner.tickCount() || i.loop)){
-      if(i.restartTimeout!=0) {
+      // virtual voice: out of hearing range sound is not started, but keeps own timer
+      if(i.restartTimeout!=0 && isInListenerRange(i.eff.position(),i.radius)) {
         auto time = owner.time();
         time = gtime(0,time.hour(),time.minute());
         if(i.sndStart<= time && time<i.sndEnd){
@@ -238,16 +253,14 @@ void WorldSound::tickSoundZone(Npc& player) {
     return;
   nextSoundUpdate = owner.tickCount()+5*1000;
 
+  const Tempest::Vec3 pos = {plPos.x,plPos.y+player.translateY(),plPos.z};
+
   Zone* zone=&def;
-  if(currentZone!=nullptr &&
-     currentZone->checkPos(plPos.x,plPos.y+player.translateY(),plPos.z)){
+  if(currentZone!=nullptr && currentZone->checkPos(pos.x,pos.y,pos.z)){
     zone = currentZone;
     } else {
-    for(auto& z:zones) {
-      if(z.checkPos(plPos.x,plPos.y+player.translateY(),plPos.z)) {
-        zone = &z;
-        }
-      }
+    if(auto z = findZone(pos))
+      zone = z;
     }
 
   gtime           time  = owner.time().timeInDay();
@@ -307,13 +320,115 @@ bool WorldSound::setMusic(const char* zone, GameMusic::Tags tags) {
   return false;
   }
 
+WorldSound::Zone* WorldSound::findZone(const Tempest::Vec3& pos) {
+  if(!zoneIndexValid)
+    mkZoneIndex();
+
+  // last matching zone wins, as in zen order
+  uint32_t ret = uint32_t(-1);
+  for(auto i:zoneLarge)
+    if(zones[i].checkPos(pos.x,pos.y,pos.z))
+      ret = (ret==uint32_t(-1) ? i : std::max(ret,i));
+
+  auto cell = zoneIndex.find(zoneCell(int(std::floor(pos.x/ZoneCellSize)),int(std::floor(pos.z/ZoneCellSize))));
+  if(cell!=zoneIndex.end()) {
+    for(auto i:cell->second)
+      if(zones[i].checkPos(pos.x,pos.y,pos.z))
+        ret = (ret==uint32_t(-1) ? i : std::max(ret,i));
+    }
+
+  if(ret==uint32_t(-1))
+    return nullptr;
+  return &zones[ret];
+  }
+
+void WorldSound::mkZoneIndex() {
+  zoneIndex.clear();
+  zoneLarge.clear();
+  for(size_t i=0; i<zones.size(); ++i) {
+    auto& z  = zones[i];
+    int   x0 = int(std::floor(z.bbox[0].x/ZoneCellSize)), x1 = int(std::floor(z.bbox[1].x/ZoneCellSize));
+    int   z0 = int(std::floor(z.bbox[0].z/ZoneCellSize)), z1 = int(std::floor(z.bbox[1].z/ZoneCellSize));
+    if(int64_t(x1-x0+1)*int64_t(z1-z0+1)>ZoneMaxCells) {
+      zoneLarge.push_back(uint32_t(i));
+      continue;
+      }
+    for(int x=x0; x<=x1; ++x)
+      for(int y=z0; y<=z1; ++y)
+        zoneIndex[zoneCell(x,y)].push_back(uint32_t(i));
+    }
+  zoneIndexValid = true;
+  }
+
+uint64_t WorldSound::zoneCell(int x, int z) {
+  return (uint64_t(uint32_t(x))<<32) | uint64_t(uint32_t(z));
+  }
+
+float WorldSound::audibility(const Tempest::Vec3& pos, float range) const {
+  const float dist = std::sqrt((pos-plPos).quadLength());
+  return std::max(0.f, 1.f-dist/(maxDist+range));
+  }
+
+float WorldSound::score(const Voice& v) const {
+  return float(v.prio) + audibility(v.eff.position(),v.range);
+  }
+
+bool WorldSound::allocVoice(const Tempest::Vec3& pos, float range, Priority prio) {
+  if(effect.size()<MaxVoices)
+    return true;
+
+  // budget is full: steal the least audible voice, or drop the new sound
+  size_t worst = 0;
+  float  wScr  = score(effect[0]);
+  for(size_t i=0; i<effect.size(); ++i) {
+    if(effect[i].eff.isFinished()) {
+      effect[i] = std::move(effect.back());
+      effect.pop_back();
+      return true;
+      }
+    float s = score(effect[i]);
+    if(s<wScr) {
+      worst = i;
+      wScr  = s;
+      }
+    }
+
+  if(wScr>=float(prio)+audibility(pos,range))
+    return false;
+  effect[worst] = std::move(effect.back());
+  effect.pop_back();
+  return true;
+  }
+
+float WorldSound::occlusion(const Tempest::Vec3& pos) {
+  const uint64_t key = (uint64_t(uint32_t(int32_t(pos.x/100.f)) & 0x1FFFFF)<<42) |
+                       (uint64_t(uint32_t(int32_t(pos.y/100.f)) & 0x1FFFFF)<<21) |
+                       (uint64_t(uint32_t(int32_t(pos.z/100.f)) & 0x1FFFFF));
+  const uint64_t now = owner.tickCount();
+
+  auto it = occCache.find(key);
+  if(it!=occCache.end()) {
+    auto& c = it->second;
+    bool  fresh = (now<c.time+OcclusionTtl) && (c.listener-plPos).quadLength()<100.f*100.f;
+    if(fresh || occRays>=MaxOcclusionRay)
+      return c.occ;
+    }
+  else if(occRays>=MaxOcclusionRay) {
+    return 0; // no budget left: treat as not occluded, until next tick
+    }
+
+  occRays++;
+  auto&     c = occCache[key];
+  c.occ      = owner.physic()->soundOclusion(plPos.x,plPos.y+180/*head pos*/,plPos.z, pos.x,pos.y,pos.z);
+  c.time     = now;
+  c.listener = plPos;
+  return c.occ;
+  }
+
 void WorldSound::tickSlot(GSoundEffect& slot) {
   if(slot.isFinished())
     return;
-  auto  dyn = owner.physic();
-  auto  pos = slot.position();
-  float occ = dyn->soundOclusion(plPos.x,plPos.y+180/*head pos*/,plPos.z, pos.x,pos.y,pos.z);
-
+  float occ = occlusion(slot.position());
   slot.setOcclusion(std::max(0.f,1.f-occ));
   }
 
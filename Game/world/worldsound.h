@@ -7,6 +7,7 @@
 #include <Tempest/Point>
 
 #include <zenload/zTypes.h>
+#include <unordered_map>
 #include <mutex>
 
 #include "game/gametime.h"
@@ -39,12 +40,39 @@ class WorldSound final {
     static const float talkRange;
 
   private:
+    enum {
+      MaxVoices       = 32,   // budget for transient effects and dialogs
+      MaxOcclusionRay = 4,    // occlusion rays per tick
+      OcclusionTtl    = 500,  // ms
+      ZoneCellSize    = 5000, // 50 meters
+      ZoneMaxCells    = 64,   // zones, that cover more cells, are checked always
+      };
+
+    enum Priority : uint8_t {
+      PrioAmbient = 0,
+      PrioEffect  = 1,
+      PrioDialog  = 2,
+      };
+
     struct Zone final {
       ZMath::float3 bbox[2]={};
       std::string   name;
       bool          checkPos(float x,float y,float z) const;
       };
 
+    struct Voice final {
+      Voice(GSoundEffect&& eff, float range, Priority prio):eff(std::move(eff)),range(range),prio(prio){}
+      GSoundEffect  eff;
+      float         range = 0;
+      Priority      prio  = PrioEffect;
+      };
+
+    struct Occlusion final {
+      float         occ      = 0;
+      uint64_t      time     = 0;
+      Tempest::Vec3 listener;
+      };
+
     struct WSound final {
       WSound(SoundFx&& s):proto(std::move(s)){}
       SoundFx      proto;
@@ -55,7 +83,7 @@ class WorldSound final {
       uint64_t     delay         =0;
       uint64_t     delayVar      =0;
       uint64_t     restartTimeout=0;
-
+      float        radius        =0;
 
       gtime        sndStart;
       gtime        sndEnd;
@@ -65,11 +93,23 @@ class WorldSound final {
     void tickSoundZone(Npc& player);
     bool setMusic(const char* zone, GameMusic::Tags tags);
 
+    Zone* findZone(const Tempest::Vec3& pos);
+    void  mkZoneIndex();
+    static uint64_t zoneCell(int x, int z);
+
+    float audibility(const Tempest::Vec3& pos, float range) const;
+    float score(const Voice& v) const;
+    bool  allocVoice(const Tempest::Vec3& pos, float range, Priority prio);
+    float occlusion(const Tempest::Vec3& pos);
+
     Gothic&                                 gothic;
     GameSession&                            game;
     World&                                  owner;
     std::vector<Zone>                       zones;
     Zone                                    def;
+    std::unordered_map<uint64_t,std::vector<uint32_t>> zoneIndex;
+    std::vector<uint32_t>                   zoneLarge;
+    bool                                    zoneIndexValid = false;
 
     uint64_t                                nextSoundUpdate=0;
     Zone*                                   currentZone = nullptr;
@@ -78,10 +118,13 @@ class WorldSound final {
     Tempest::Vec3                           plPos;
 
     std::unordered_map<std::string,GSoundEffect> freeSlot;
-    std::vector<GSoundEffect>               effect;
-    std::vector<GSoundEffect>               effect3d; // snd_play3d
+    std::vector<Voice>                      effect;
     std::vector<WSound>                     worldEff;
 
+    std::unordered_map<uint64_t,Occlusion>  occCache;
+    uint32_t                                occRays = 0;
+    uint64_t                                occNextSweep = 0;
+
     std::mutex                              sync;
 
     static const float maxDist;
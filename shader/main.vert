@@ -10,15 +10,13 @@ out gl_PerVertex {
   };
 
 #ifdef SKINING
-layout(location = 0) in vec3 inNormal;
-layout(location = 1) in vec2 inUV;
+// Resources::VertexA: every attribute is fetched as unorm8x4 and unpacked here
+layout(location = 0) in vec4 inNormalPk; // octahedral, snorm16x2
+layout(location = 1) in vec4 inUVPk;     // half2
 layout(location = 2) in vec4 inColor;
-layout(location = 3) in vec3 inPos0;
-layout(location = 4) in vec3 inPos1;
-layout(location = 5) in vec3 inPos2;
-layout(location = 6) in vec3 inPos3;
-layout(location = 7) in vec4 inId;
-layout(location = 8) in vec4 inWeight;
+layout(location = 3) in vec4 inPosPk[6]; // 4 x half3
+layout(location = 9) in vec4 inId;
+layout(location =10) in vec4 inWeight;
 #else
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inNormal;
@@ -38,12 +36,37 @@ layout(location = 4) out vec4 outPos;
 layout(location = 5) out vec4 outScr;
 #endif
 
+#ifdef SKINING
+uint unpackBytes(vec4 v) {
+  uvec4 b = uvec4(round(v*255.0));
+  return b.x | (b.y<<8) | (b.z<<16) | (b.w<<24);
+  }
+
+vec3 unpackNormal() {
+  vec2 e = unpackSnorm2x16(unpackBytes(inNormalPk));
+  vec3 n = vec3(e, 1.0-abs(e.x)-abs(e.y));
+  if(n.z<0.0)
+    n.xy = (1.0-abs(n.yx))*vec2(n.x>=0.0 ? 1.0 : -1.0, n.y>=0.0 ? 1.0 : -1.0);
+  return normalize(n);
+  }
+
+vec2 unpackUV() {
+  return unpackHalf2x16(unpackBytes(inUVPk));
+  }
+#endif
+
 vec4 vertexPos() {
 #ifdef SKINING
-  vec4 pos0 = vec4(inPos0,1.0);
-  vec4 pos1 = vec4(inPos1,1.0);
-  vec4 pos2 = vec4(inPos2,1.0);
-  vec4 pos3 = vec4(inPos3,1.0);
+  vec2 h0   = unpackHalf2x16(unpackBytes(inPosPk[0]));
+  vec2 h1   = unpackHalf2x16(unpackBytes(inPosPk[1]));
+  vec2 h2   = unpackHalf2x16(unpackBytes(inPosPk[2]));
+  vec2 h3   = unpackHalf2x16(unpackBytes(inPosPk[3]));
+  vec2 h4   = unpackHalf2x16(unpackBytes(inPosPk[4]));
+  vec2 h5   = unpackHalf2x16(unpackBytes(inPosPk[5]));
+  vec4 pos0 = vec4(h0.x,h0.y,h1.x,1.0);
+  vec4 pos1 = vec4(h1.y,h2.x,h2.y,1.0);
+  vec4 pos2 = vec4(h3.x,h3.y,h4.x,1.0);
+  vec4 pos3 = vec4(h4.y,h5.x,h5.y,1.0);
   vec4 t0   = anim.skel[int(inId.x*255.0)]*pos0;
   vec4 t1   = anim.skel[int(inId.y*255.0)]*pos1;
   vec4 t2   = anim.skel[int(inId.z*255.0)]*pos2;
@@ -57,25 +80,30 @@ vec4 vertexPos() {
 vec4 normal(){
 #ifdef SKINING
   //vec4 norm = vec4(inNormal.z,inNormal.y,inNormal.x,0.0);
-  vec4 norm = vec4(inNormal,0.0);
-  vec4 n0   = anim.skel[int(inId.x)]*norm;
-  vec4 n1   = anim.skel[int(inId.y)]*norm;
-  vec4 n2   = anim.skel[int(inId.z)]*norm;
-  vec4 n3   = anim.skel[int(inId.w)]*norm;
+  vec4 norm = vec4(unpackNormal(),0.0);
+  vec4 n0   = anim.skel[int(inId.x*255.0)]*norm;
+  vec4 n1   = anim.skel[int(inId.y*255.0)]*norm;
+  vec4 n2   = anim.skel[int(inId.z*255.0)]*norm;
+  vec4 n3   = anim.skel[int(inId.w*255.0)]*norm;
   vec4 n    = (n0*inWeight.x + n1*inWeight.y + n2*inWeight.z + n3*inWeight.w);
   return vec4(n.xyz,0.0);
-#endif
-#ifdef OBJ
+#elif defined(OBJ)
   return vec4(inNormal.x,inNormal.y,inNormal.z,0.0);
-#endif
+#else
   return vec4(-inNormal.z,inNormal.y,inNormal.x,0.0);
+#endif
   }
 
 void main() {
+#if defined(SKINING)
+  vec2 uv    = unpackUV();
+#else
+  vec2 uv    = inUV;
+#endif
 #if defined(OBJ)
-  outUV      = inUV + material.texAnim;
+  outUV      = uv + material.texAnim;
 #else
-  outUV      = inUV;
+  outUV      = uv;
 #endif
 
   vec4 pos   = vertexPos();